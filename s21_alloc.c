@@ -0,0 +1,168 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "s21_simd.h"
+#include "s21_string.h"
+
+// ALLOCATORS
+
+typedef struct {
+  s21_alloc_fn alloc;
+  s21_realloc_fn realloc;
+  s21_free_fn free;
+  void *ctx;
+} s21_allocator;
+
+// No hooks (alloc == s21_NULL) means the C library allocator. The thread
+// override wins over the process-wide hooks.
+static s21_allocator s21_global_allocator;
+static _Thread_local s21_allocator s21_thread_allocator;
+
+static void s21_allocator_set(s21_allocator *a, s21_alloc_fn alloc,
+                              s21_realloc_fn realloc_fn, s21_free_fn free_fn,
+                              void *ctx) {
+  int complete = alloc != s21_NULL && realloc_fn != s21_NULL &&
+                 free_fn != s21_NULL;
+  a->alloc = complete ? alloc : s21_NULL;
+  a->realloc = complete ? realloc_fn : s21_NULL;
+  a->free = complete ? free_fn : s21_NULL;
+  a->ctx = complete ? ctx : s21_NULL;
+}
+
+static const s21_allocator *s21_allocator_current(void) {
+  const s21_allocator *a = s21_NULL;
+  if (s21_thread_allocator.alloc != s21_NULL)
+    a = &s21_thread_allocator;
+  else if (s21_global_allocator.alloc != s21_NULL)
+    a = &s21_global_allocator;
+  return a;
+}
+
+void s21_set_allocator(s21_alloc_fn alloc, s21_realloc_fn realloc_fn,
+                       s21_free_fn free_fn, void *ctx) {
+  s21_allocator_set(&s21_global_allocator, alloc, realloc_fn, free_fn, ctx);
+}
+
+void s21_set_thread_allocator(s21_alloc_fn alloc, s21_realloc_fn realloc_fn,
+                              s21_free_fn free_fn, void *ctx) {
+  s21_allocator_set(&s21_thread_allocator, alloc, realloc_fn, free_fn, ctx);
+}
+
+void *s21_malloc(s21_size_t size) {
+  const s21_allocator *a = s21_allocator_current();
+  return a != s21_NULL ? a->alloc(size, a->ctx) : malloc(size);
+}
+
+void *s21_calloc(s21_size_t count, s21_size_t size) {
+  void *ptr = s21_NULL;
+  const s21_allocator *a = s21_allocator_current();
+  if (a == s21_NULL) {
+    ptr = calloc(count, size);
+  } else if (size == 0 || count <= (s21_size_t)-1 / size) {
+    ptr = a->alloc(count * size, a->ctx);
+    if (ptr != s21_NULL) s21_memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+void *s21_realloc(void *ptr, s21_size_t size) {
+  const s21_allocator *a = s21_allocator_current();
+  return a != s21_NULL ? a->realloc(ptr, size, a->ctx) : realloc(ptr, size);
+}
+
+void s21_free(void *ptr) {
+  const s21_allocator *a = s21_allocator_current();
+  if (a == s21_NULL)
+    free(ptr);
+  else if (ptr != s21_NULL)
+    a->free(ptr, a->ctx);
+}
+
+// ARENA
+
+// Alignment of every block, enough for any object type.
+#define S21_ARENA_ALIGN _Alignof(max_align_t)
+#define S21_ARENA_CHUNK 4096
+
+struct s21_arena_chunk {
+  struct s21_arena_chunk *next;
+  s21_size_t size;
+};
+
+void s21_arena_init(s21_arena *arena, s21_size_t chunk_size) {
+  arena->first = s21_NULL;
+  arena->current = s21_NULL;
+  arena->pos = s21_NULL;
+  arena->end = s21_NULL;
+  arena->chunk_size = chunk_size != 0 ? chunk_size : S21_ARENA_CHUNK;
+}
+
+// Moves to the chunk after the current one, or to a new chunk put there
+// when it is missing or too small for size bytes.
+static int s21_arena_next_chunk(s21_arena *arena, s21_size_t size) {
+  s21_arena_chunk *next =
+      arena->current != s21_NULL ? arena->current->next : arena->first;
+  if (size > (s21_size_t)-1 - S21_ARENA_ALIGN - sizeof(*next)) return -1;
+  if (next == s21_NULL || next->size < size + S21_ARENA_ALIGN) {
+    s21_size_t data = size + S21_ARENA_ALIGN;
+    if (data < arena->chunk_size) data = arena->chunk_size;
+    s21_arena_chunk *chunk = s21_malloc(sizeof(*chunk) + data);
+    if (chunk == s21_NULL) return -1;
+    chunk->size = data;
+    chunk->next = next;
+    if (arena->current != s21_NULL)
+      arena->current->next = chunk;
+    else
+      arena->first = chunk;
+    next = chunk;
+  }
+  arena->current = next;
+  arena->pos = (char *)(next + 1);
+  arena->end = arena->pos + next->size;
+  return 0;
+}
+
+char *s21_arena_space(s21_arena *arena, s21_size_t *room) {
+  uintptr_t pos = ((uintptr_t)arena->pos + S21_ARENA_ALIGN - 1) &
+                  ~(uintptr_t)(S21_ARENA_ALIGN - 1);
+  char *res = s21_NULL;
+  *room = 0;
+  if (arena->pos != s21_NULL && pos <= (uintptr_t)arena->end) {
+    *room = (s21_size_t)((uintptr_t)arena->end - pos);
+    res = (char *)pos;
+  }
+  return res;
+}
+
+void *s21_arena_alloc(s21_arena *arena, s21_size_t size) {
+  s21_size_t room;
+  char *res = s21_arena_space(arena, &room);
+  if (res == s21_NULL || room < size) {
+    res = s21_NULL;
+    if (s21_arena_next_chunk(arena, size) == 0)
+      res = s21_arena_space(arena, &room);
+  }
+  if (res != s21_NULL) arena->pos = res + size;
+  return res;
+}
+
+void s21_arena_reset(s21_arena *arena) {
+  arena->current = arena->first;
+  arena->pos = s21_NULL;
+  arena->end = s21_NULL;
+  if (arena->first != s21_NULL) {
+    arena->pos = (char *)(arena->first + 1);
+    arena->end = arena->pos + arena->first->size;
+  }
+}
+
+void s21_arena_free(s21_arena *arena) {
+  s21_arena_chunk *chunk = arena->first;
+  while (chunk != s21_NULL) {
+    s21_arena_chunk *next = chunk->next;
+    s21_free(chunk);
+    chunk = next;
+  }
+  s21_arena_init(arena, arena->chunk_size);
+}
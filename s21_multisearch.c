@@ -0,0 +1,324 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "s21_simd.h"
+#include "s21_string.h"
+
+// Pattern sets up to this size on a CPU with AVX2 go through the Teddy
+// filter, larger ones through the Aho-Corasick automaton.
+#define S21_TEDDY_MAX_PATTERNS 16
+
+// Transition targets carry this bit when the target state reports matches,
+// so the scan loop tests one bit per byte instead of loading output lists.
+// Automata of up to S21_AC_MATCH16 transitions store them in 16 bits, which
+// halves the table and keeps a few hundred keywords in L1.
+#define S21_AC_MATCH 0x80000000U
+#define S21_AC_MATCH16 0x8000U
+
+#define S21_NO_PATTERN ((s21_size_t)-1)
+
+struct s21_multisearch {
+  int teddy;
+  s21_size_t count;
+  s21_size_t *lens;
+  s21_size_t *starts;
+  unsigned char *bytes;
+
+  // Teddy: patterns are spread over 8 buckets, each a linked list.
+  s21_teddy masks;
+  s21_size_t bucket_head[8];
+  s21_size_t *bucket_next;
+
+  // Aho-Corasick: a dense DFA over byte classes. Bytes that occur in no
+  // pattern share class 0. A transition holds the target state multiplied
+  // by the number of classes, so a step is one load and one add; small
+  // automata keep their table in delta16 instead of delta. State s
+  // reports patterns out_ids[out_start[s]..out_start[s + 1]) and then those
+  // of state dict[s], the nearest suffix state with matches (0 if none).
+  unsigned char classes[256];
+  uint32_t nclasses;
+  uint32_t *delta;
+  uint16_t *delta16;
+  uint32_t *out_start;
+  uint32_t *out_ids;
+  uint32_t *dict;
+};
+
+// DATA PREPARATION
+
+static int s21_multisearch_copy(s21_multisearch_t *ms,
+                                const char *const *needles,
+                                s21_size_t count) {
+  s21_size_t total = 0;
+  int ok = 1;
+  ms->count = count;
+  ms->lens = s21_malloc((count + 1) * sizeof(*ms->lens));
+  ms->starts = s21_malloc((count + 1) * sizeof(*ms->starts));
+  ok = ms->lens != s21_NULL && ms->starts != s21_NULL;
+  for (s21_size_t i = 0; ok && i < count; i++) {
+    ok = needles[i] != s21_NULL;
+    if (ok) {
+      ms->lens[i] = s21_strlen(needles[i]);
+      ms->starts[i] = total;
+      total += ms->lens[i];
+    }
+  }
+  if (ok) ms->bytes = s21_malloc(total + 1);
+  ok = ok && ms->bytes != s21_NULL;
+  for (s21_size_t i = 0; ok && i < count; i++) {
+    s21_memcpy(ms->bytes + ms->starts[i], needles[i], ms->lens[i]);
+  }
+  return ok;
+}
+
+static int s21_teddy_build(s21_multisearch_t *ms) {
+  s21_size_t shortest = S21_NO_PATTERN;
+  s21_memset(&ms->masks, 0, sizeof(ms->masks));
+  for (int b = 0; b < 8; b++) ms->bucket_head[b] = S21_NO_PATTERN;
+  ms->bucket_next = s21_malloc((ms->count + 1) * sizeof(*ms->bucket_next));
+  for (s21_size_t i = 0; i < ms->count; i++) {
+    if (ms->lens[i] && ms->lens[i] < shortest) shortest = ms->lens[i];
+  }
+  ms->masks.len = shortest == S21_NO_PATTERN ? 0
+                  : shortest < 3              ? (int)shortest
+                                              : 3;
+  // Patterns go into buckets in reverse so each list is in id order.
+  for (s21_size_t i = ms->count; ms->bucket_next != s21_NULL && i-- > 0;) {
+    if (ms->lens[i]) {
+      const unsigned char *x = ms->bytes + ms->starts[i];
+      int b = (int)(i % 8);
+      for (int j = 0; j < ms->masks.len; j++) {
+        ms->masks.lo[j][x[j] & 15] |= (unsigned char)(1 << b);
+        ms->masks.hi[j][x[j] >> 4] |= (unsigned char)(1 << b);
+      }
+      ms->bucket_next[i] = ms->bucket_head[b];
+      ms->bucket_head[b] = i;
+    }
+  }
+  return ms->bucket_next != s21_NULL;
+}
+
+static int s21_ac_build(s21_multisearch_t *ms) {
+  s21_size_t total = 1;
+  uint32_t k = 1, states = 1, head = 0, tail = 0;
+  uint32_t *end = s21_NULL, *fail = s21_NULL, *queue = s21_NULL;
+  int ok = 1;
+
+  s21_memset(ms->classes, 0, sizeof(ms->classes));
+  for (s21_size_t i = 0; i < ms->count; i++) {
+    const unsigned char *x = ms->bytes + ms->starts[i];
+    for (s21_size_t j = 0; j < ms->lens[i]; j++) {
+      if (ms->classes[x[j]] == 0) ms->classes[x[j]] = (unsigned char)k++;
+    }
+    total += ms->lens[i];
+  }
+  ms->nclasses = k;
+  ok = total * k < S21_AC_MATCH;
+  if (ok) {
+    ms->delta = s21_calloc(total * k, sizeof(*ms->delta));
+    ms->out_start = s21_calloc(total + 1, sizeof(*ms->out_start));
+    ms->out_ids = s21_malloc((ms->count + 1) * sizeof(*ms->out_ids));
+    ms->dict = s21_calloc(total, sizeof(*ms->dict));
+    end = s21_malloc((ms->count + 1) * sizeof(*end));
+    fail = s21_calloc(total, sizeof(*fail));
+    queue = s21_malloc(total * sizeof(*queue));
+    ok = ms->delta && ms->out_start && ms->out_ids && ms->dict && end &&
+         fail && queue;
+  }
+
+  // Trie. State 0 is the root and is never a child, so 0 marks a missing
+  // edge until the rows are completed below.
+  for (s21_size_t i = 0; ok && i < ms->count; i++) {
+    const unsigned char *x = ms->bytes + ms->starts[i];
+    uint32_t s = 0;
+    for (s21_size_t j = 0; j < ms->lens[i]; j++) {
+      uint32_t *edge = &ms->delta[s * k + ms->classes[x[j]]];
+      if (*edge == 0) *edge = states++;
+      s = *edge;
+    }
+    end[i] = s;
+  }
+
+  // Output lists, bucketed by state with a counting sort. Empty patterns
+  // end at the root and are left out, they never match.
+  for (s21_size_t i = 0; ok && i < ms->count; i++) {
+    if (end[i]) ms->out_start[end[i] + 1]++;
+  }
+  for (uint32_t s = 0; ok && s < states; s++) {
+    ms->out_start[s + 1] += ms->out_start[s];
+  }
+  for (s21_size_t i = 0; ok && i < ms->count; i++) {
+    if (end[i]) ms->out_ids[ms->out_start[end[i]] + fail[end[i]]++] = i;
+  }
+  if (ok) s21_memset(fail, 0, total * sizeof(*fail));
+
+  // Breadth-first pass: when state s is dequeued its row still holds only
+  // trie edges and every state of smaller depth is complete, so missing
+  // edges are copied from the row of the failure state.
+  for (uint32_t c = 0; ok && c < k; c++) {
+    if (ms->delta[c]) queue[tail++] = ms->delta[c];
+  }
+  while (ok && head < tail) {
+    uint32_t s = queue[head++];
+    for (uint32_t c = 0; c < k; c++) {
+      uint32_t t = ms->delta[s * k + c];
+      uint32_t f = ms->delta[fail[s] * k + c];
+      if (t != 0) {
+        fail[t] = f;
+        ms->dict[t] = ms->out_start[f + 1] > ms->out_start[f] ? f : ms->dict[f];
+        queue[tail++] = t;
+      } else {
+        ms->delta[s * k + c] = f;
+      }
+    }
+  }
+
+  for (s21_size_t e = 0; ok && e < (s21_size_t)states * k; e++) {
+    uint32_t t = ms->delta[e];
+    int matches = ms->out_start[t + 1] > ms->out_start[t] || ms->dict[t];
+    ms->delta[e] = t * k | (matches ? S21_AC_MATCH : 0);
+  }
+  if (ok && (s21_size_t)states * k <= S21_AC_MATCH16) {
+    ms->delta16 = s21_malloc((s21_size_t)states * k * sizeof(*ms->delta16));
+    for (s21_size_t e = 0; ms->delta16 && e < (s21_size_t)states * k; e++) {
+      uint32_t t = ms->delta[e];
+      ms->delta16[e] = (uint16_t)((t & ~S21_AC_MATCH) |
+                                  (t & S21_AC_MATCH ? S21_AC_MATCH16 : 0));
+    }
+    if (ms->delta16 != s21_NULL) {
+      s21_free(ms->delta);
+      ms->delta = s21_NULL;
+    }
+  }
+  s21_free(end);
+  s21_free(fail);
+  s21_free(queue);
+  return ok;
+}
+
+s21_multisearch_t *s21_multisearch_compile(const char *const *needles,
+                                           s21_size_t count) {
+  s21_multisearch_t *ms = s21_NULL;
+  if (needles != s21_NULL) ms = s21_calloc(1, sizeof(*ms));
+  if (ms != s21_NULL) {
+    int ok = s21_multisearch_copy(ms, needles, count);
+    ms->teddy = count <= S21_TEDDY_MAX_PATTERNS &&
+                (s21_cpu_features() & S21_CPU_AVX2);
+    if (ok && ms->teddy) ok = s21_teddy_build(ms);
+    if (ok && !ms->teddy) ok = s21_ac_build(ms);
+    if (!ok) {
+      s21_multisearch_free(ms);
+      ms = s21_NULL;
+    }
+  }
+  return ms;
+}
+
+// SEARCH
+
+static s21_size_t s21_teddy_scan(const s21_multisearch_t *ms,
+                                 const unsigned char *hay, s21_size_t n,
+                                 s21_match_callback on_match, void *ctx) {
+  s21_size_t found = 0, pos = 0, fp = (s21_size_t)ms->masks.len;
+  unsigned char buckets[64];
+  int stop = fp == 0 || fp > n;
+  while (!stop && pos < n - fp + 1) {
+    uint64_t mask =
+        s21_teddy_kernel(&ms->masks, hay, n - fp + 1, &pos, buckets);
+    if (mask == 0) break;
+    for (; !stop && mask; mask &= mask - 1) {
+      int k = S21_CTZLL(mask);
+      const unsigned char *p = hay + pos + k;
+      for (int b = 0; !stop && b < 8; b++) {
+        if (!(buckets[k] & (1U << b))) continue;
+        for (s21_size_t i = ms->bucket_head[b]; !stop && i != S21_NO_PATTERN;
+             i = ms->bucket_next[i]) {
+          if (ms->lens[i] <= n - pos - k &&
+              s21_memeq(p, ms->bytes + ms->starts[i], ms->lens[i])) {
+            found++;
+            if (on_match != s21_NULL) stop = on_match(i, pos + k, ctx);
+          }
+        }
+      }
+    }
+    pos += 64;
+  }
+  return found;
+}
+
+// Reports the matches of the state whose table offset is row, which end
+// just before end, and returns nonzero when on_match asks to stop.
+static int s21_ac_report(const s21_multisearch_t *ms, uint32_t row,
+                         s21_size_t end, s21_size_t *found,
+                         s21_match_callback on_match, void *ctx) {
+  int stop = 0;
+  for (uint32_t t = row / ms->nclasses; !stop && t; t = ms->dict[t]) {
+    for (uint32_t o = ms->out_start[t]; !stop && o < ms->out_start[t + 1];
+         o++) {
+      s21_size_t id = ms->out_ids[o];
+      ++*found;
+      if (on_match != s21_NULL) stop = on_match(id, end - ms->lens[id], ctx);
+    }
+  }
+  return stop;
+}
+
+static s21_size_t s21_ac_scan(const s21_multisearch_t *ms,
+                              const unsigned char *hay, s21_size_t n,
+                              s21_match_callback on_match, void *ctx) {
+  s21_size_t found = 0;
+  int stop = 0;
+  if (ms->delta16 != s21_NULL) {
+    const uint16_t *delta = ms->delta16;
+    uint16_t s = 0;
+    for (s21_size_t i = 0; !stop && i < n; i++) {
+      s = delta[(s & ~S21_AC_MATCH16) + ms->classes[hay[i]]];
+      if (s & S21_AC_MATCH16) {
+        stop = s21_ac_report(ms, s & ~S21_AC_MATCH16, i + 1, &found, on_match,
+                             ctx);
+      }
+    }
+  } else {
+    const uint32_t *delta = ms->delta;
+    uint32_t s = 0;
+    for (s21_size_t i = 0; !stop && i < n; i++) {
+      s = delta[(s & ~S21_AC_MATCH) + ms->classes[hay[i]]];
+      if (s & S21_AC_MATCH) {
+        stop = s21_ac_report(ms, s & ~S21_AC_MATCH, i + 1, &found, on_match,
+                             ctx);
+      }
+    }
+  }
+  return found;
+}
+
+s21_size_t s21_multisearch_scan(const s21_multisearch_t *ms,
+                                const char *haystack, s21_size_t len,
+                                s21_match_callback on_match, void *ctx) {
+  s21_size_t found = 0;
+  const unsigned char *hay = (const unsigned char *)haystack;
+  if (ms != s21_NULL && haystack != s21_NULL) {
+    found = ms->teddy ? s21_teddy_scan(ms, hay, len, on_match, ctx)
+                      : s21_ac_scan(ms, hay, len, on_match, ctx);
+  }
+  return found;
+}
+
+const char *s21_multisearch_algorithm(const s21_multisearch_t *ms) {
+  return ms == s21_NULL ? "none" : ms->teddy ? "teddy" : "aho-corasick";
+}
+
+void s21_multisearch_free(s21_multisearch_t *ms) {
+  if (ms != s21_NULL) {
+    s21_free(ms->lens);
+    s21_free(ms->starts);
+    s21_free(ms->bytes);
+    s21_free(ms->bucket_next);
+    s21_free(ms->delta);
+    s21_free(ms->delta16);
+    s21_free(ms->out_start);
+    s21_free(ms->out_ids);
+    s21_free(ms->dict);
+    s21_free(ms);
+  }
+}
@@ -0,0 +1,1753 @@
+#include "s21_simd.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#if S21_X86
+#include <cpuid.h>
+#endif
+
+// CPU DETECTION
+
+static int s21_features = -1;
+
+static int s21_cap_features(int features) {
+  const char *level = getenv("S21_SIMD");
+  if (level != s21_NULL) {
+    if (!s21_strcmp(level, "swar"))
+      features = 0;
+    else if (!s21_strcmp(level, "sse2"))
+      features &= S21_CPU_SSE2;
+    else if (!s21_strcmp(level, "avx2"))
+      features &= S21_CPU_SSE2 | S21_CPU_AVX2;
+  }
+  return features;
+}
+
+int s21_cpu_features(void) {
+  if (s21_features < 0) {
+    int features = 0;
+#if S21_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) features |= S21_CPU_SSE2;
+    if (__builtin_cpu_supports("avx2")) features |= S21_CPU_AVX2;
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512bw"))
+      features |= S21_CPU_AVX512;
+#endif
+    s21_features = s21_cap_features(features);
+  }
+  return s21_features;
+}
+
+static const char *const s21_level_names[] = {"swar", "sse2", "avx2",
+                                              "avx512"};
+
+static int s21_level(void) {
+  int features = s21_cpu_features();
+  int level = 0;
+  if (features & S21_CPU_AVX512)
+    level = 3;
+  else if (features & S21_CPU_AVX2)
+    level = 2;
+  else if (features & S21_CPU_SSE2)
+    level = 1;
+  return level;
+}
+
+const char *s21_simd_level(void) { return s21_level_names[s21_level()]; }
+
+#if S21_X86
+static s21_size_t s21_cpuid_cache_size(unsigned leaf) {
+  s21_size_t size = 0;
+  unsigned a, b, c, d;
+  for (unsigned i = 0; i < 16 && __get_cpuid_count(leaf, i, &a, &b, &c, &d) &&
+                       (a & 0x1f) != 0;
+       i++) {
+    s21_size_t ways = (b >> 22) + 1;
+    s21_size_t partitions = ((b >> 12) & 0x3ff) + 1;
+    s21_size_t line = (b & 0xfff) + 1;
+    s21_size_t sets = (s21_size_t)c + 1;
+    if (ways * partitions * line * sets > size)
+      size = ways * partitions * line * sets;
+  }
+  return size;
+}
+#endif
+
+s21_size_t s21_cache_size(void) {
+  s21_size_t size = 0;
+#if S21_X86
+  size = s21_cpuid_cache_size(4);
+  if (size == 0) size = s21_cpuid_cache_size(0x8000001d);
+#endif
+  return size ? size : 8ULL << 20;
+}
+
+// STRLEN KERNELS
+
+// All kernels read whole aligned blocks only, including the bytes before
+// the string and past its terminator in the first and last block. The
+// over-read is deliberate: an aligned block never straddles a page, so it
+// cannot fault, and S21_NO_SANITIZE keeps AddressSanitizer quiet about it.
+
+S21_NO_SANITIZE
+static s21_size_t s21_strlen_swar(const char *str) {
+  const char *p = str;
+  while ((uintptr_t)p % sizeof(s21_word) != 0 && *p) p++;
+  if (*p) {
+    const s21_word *w = (const s21_word *)p;
+    while (!S21_HASZERO(*w)) w++;
+    p = (const char *)w;
+    while (*p) p++;
+  }
+  return p - str;
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+S21_NO_SANITIZE
+static s21_size_t s21_strlen_sse2(const char *str) {
+  const __m128i zero = _mm_setzero_si128();
+  uintptr_t off = (uintptr_t)str % 16;
+  const char *p = str - off;
+  unsigned mask =
+      _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p),
+                                       zero)) >>
+      off;
+  if (mask == 0) {
+    p += 16;
+    while ((uintptr_t)p % 64 != 0 && mask == 0) {
+      mask = _mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), zero));
+      if (mask == 0) p += 16;
+    }
+    while (mask == 0) {
+      __m128i v0 = _mm_load_si128((const __m128i *)p);
+      __m128i v1 = _mm_load_si128((const __m128i *)(p + 16));
+      __m128i v2 = _mm_load_si128((const __m128i *)(p + 32));
+      __m128i v3 = _mm_load_si128((const __m128i *)(p + 48));
+      __m128i min = _mm_min_epu8(_mm_min_epu8(v0, v1), _mm_min_epu8(v2, v3));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(min, zero)) == 0) {
+        p += 64;
+        continue;
+      }
+      mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v0, zero));
+      while (mask == 0) {
+        p += 16;
+        mask = _mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), zero));
+      }
+    }
+    off = 0;
+  }
+  return (p + off + S21_CTZ(mask)) - str;
+}
+
+S21_TARGET("avx2")
+S21_NO_SANITIZE
+static s21_size_t s21_strlen_avx2(const char *str) {
+  const __m256i zero = _mm256_setzero_si256();
+  uintptr_t off = (uintptr_t)str % 32;
+  const char *p = str - off;
+  unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                      _mm256_load_si256((const __m256i *)p), zero)) >>
+                  off;
+  if (mask == 0) {
+    p += 32;
+    while ((uintptr_t)p % 128 != 0 && mask == 0) {
+      mask = (unsigned)_mm256_movemask_epi8(
+          _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), zero));
+      if (mask == 0) p += 32;
+    }
+    while (mask == 0) {
+      __m256i v0 = _mm256_load_si256((const __m256i *)p);
+      __m256i v1 = _mm256_load_si256((const __m256i *)(p + 32));
+      __m256i v2 = _mm256_load_si256((const __m256i *)(p + 64));
+      __m256i v3 = _mm256_load_si256((const __m256i *)(p + 96));
+      __m256i min =
+          _mm256_min_epu8(_mm256_min_epu8(v0, v1), _mm256_min_epu8(v2, v3));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(min, zero)) == 0) {
+        p += 128;
+        continue;
+      }
+      mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, zero));
+      while (mask == 0) {
+        p += 32;
+        mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), zero));
+      }
+    }
+    off = 0;
+  }
+  return (p + off + S21_CTZ(mask)) - str;
+}
+
+S21_TARGET("avx512f,avx512bw")
+S21_NO_SANITIZE
+static s21_size_t s21_strlen_avx512(const char *str) {
+  const __m512i zero = _mm512_setzero_si512();
+  uintptr_t off = (uintptr_t)str % 64;
+  const char *p = str - off;
+  uint64_t mask =
+      _mm512_cmpeq_epi8_mask(_mm512_load_si512((const void *)p), zero) >> off;
+  if (mask == 0) {
+    p += 64;
+    if ((uintptr_t)p % 128 != 0) {
+      mask = _mm512_cmpeq_epi8_mask(_mm512_load_si512((const void *)p), zero);
+      if (mask == 0) p += 64;
+    }
+    while (mask == 0) {
+      __m512i v0 = _mm512_load_si512((const void *)p);
+      __m512i v1 = _mm512_load_si512((const void *)(p + 64));
+      if (_mm512_cmpeq_epi8_mask(_mm512_min_epu8(v0, v1), zero) == 0) {
+        p += 128;
+        continue;
+      }
+      mask = _mm512_cmpeq_epi8_mask(v0, zero);
+      if (mask == 0) {
+        p += 64;
+        mask = _mm512_cmpeq_epi8_mask(v1, zero);
+      }
+    }
+    off = 0;
+  }
+  return (p + off + S21_CTZLL(mask)) - str;
+}
+
+#endif
+
+// COPY KERNELS
+
+// Every kernel loads the first and the last block of the buffer before it
+// stores anything. Copies of up to two blocks are just two overlapping
+// loads and stores, and the main loop can use aligned stores without a
+// ragged tail. Each loop iteration loads before it stores, so a forward copy
+// to a lower overlapping address is also correct.
+
+static void s21_copy_small(char *d, const char *s, s21_size_t n) {
+  if (n >= 8) {
+    uint64_t head = S21_LOAD64(s), tail = S21_LOAD64(s + n - 8);
+    S21_STORE64(d, head);
+    S21_STORE64(d + n - 8, tail);
+  } else if (n >= 4) {
+    uint32_t head = S21_LOAD32(s), tail = S21_LOAD32(s + n - 4);
+    S21_STORE32(d, head);
+    S21_STORE32(d + n - 4, tail);
+  } else if (n >= 2) {
+    uint16_t head = S21_LOAD16(s), tail = S21_LOAD16(s + n - 2);
+    S21_STORE16(d, head);
+    S21_STORE16(d + n - 2, tail);
+  } else if (n == 1) {
+    *d = *s;
+  }
+}
+
+static void s21_copy_swar(char *d, const char *s, s21_size_t n) {
+  if (n <= 16) {
+    s21_copy_small(d, s, n);
+  } else {
+    uint64_t head = S21_LOAD64(s), tail = S21_LOAD64(s + n - 8);
+    s21_size_t i = 8 - (uintptr_t)d % 8;
+    for (; i + 32 <= n; i += 32) {
+      uint64_t w0 = S21_LOAD64(s + i), w1 = S21_LOAD64(s + i + 8);
+      uint64_t w2 = S21_LOAD64(s + i + 16), w3 = S21_LOAD64(s + i + 24);
+      *(s21_word *)(d + i) = w0;
+      *(s21_word *)(d + i + 8) = w1;
+      *(s21_word *)(d + i + 16) = w2;
+      *(s21_word *)(d + i + 24) = w3;
+    }
+    for (; i + 8 <= n; i += 8) *(s21_word *)(d + i) = S21_LOAD64(s + i);
+    S21_STORE64(d + n - 8, tail);
+    S21_STORE64(d, head);
+  }
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+static void s21_copy_sse2(char *d, const char *s, s21_size_t n) {
+  if (n <= 16) {
+    s21_copy_small(d, s, n);
+  } else if (n <= 32) {
+    __m128i head = _mm_loadu_si128((const __m128i *)s);
+    __m128i tail = _mm_loadu_si128((const __m128i *)(s + n - 16));
+    _mm_storeu_si128((__m128i *)d, head);
+    _mm_storeu_si128((__m128i *)(d + n - 16), tail);
+  } else {
+    __m128i head = _mm_loadu_si128((const __m128i *)s);
+    __m128i tail = _mm_loadu_si128((const __m128i *)(s + n - 16));
+    s21_size_t i = 16 - (uintptr_t)d % 16;
+    if (n >= s21_stream_threshold) {
+      for (; i + 64 <= n; i += 64) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(s + i + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(s + i + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(s + i + 48));
+        _mm_stream_si128((__m128i *)(d + i), v0);
+        _mm_stream_si128((__m128i *)(d + i + 16), v1);
+        _mm_stream_si128((__m128i *)(d + i + 32), v2);
+        _mm_stream_si128((__m128i *)(d + i + 48), v3);
+      }
+      _mm_sfence();
+    }
+    for (; i + 64 <= n; i += 64) {
+      __m128i v0 = _mm_loadu_si128((const __m128i *)(s + i));
+      __m128i v1 = _mm_loadu_si128((const __m128i *)(s + i + 16));
+      __m128i v2 = _mm_loadu_si128((const __m128i *)(s + i + 32));
+      __m128i v3 = _mm_loadu_si128((const __m128i *)(s + i + 48));
+      _mm_store_si128((__m128i *)(d + i), v0);
+      _mm_store_si128((__m128i *)(d + i + 16), v1);
+      _mm_store_si128((__m128i *)(d + i + 32), v2);
+      _mm_store_si128((__m128i *)(d + i + 48), v3);
+    }
+    for (; i + 16 <= n; i += 16)
+      _mm_store_si128((__m128i *)(d + i),
+                      _mm_loadu_si128((const __m128i *)(s + i)));
+    _mm_storeu_si128((__m128i *)(d + n - 16), tail);
+    _mm_storeu_si128((__m128i *)d, head);
+  }
+}
+
+S21_TARGET("avx2")
+static void s21_copy_avx2(char *d, const char *s, s21_size_t n) {
+  if (n <= 32) {
+    s21_copy_sse2(d, s, n);
+  } else if (n <= 64) {
+    __m256i head = _mm256_loadu_si256((const __m256i *)s);
+    __m256i tail = _mm256_loadu_si256((const __m256i *)(s + n - 32));
+    _mm256_storeu_si256((__m256i *)d, head);
+    _mm256_storeu_si256((__m256i *)(d + n - 32), tail);
+  } else {
+    __m256i head = _mm256_loadu_si256((const __m256i *)s);
+    __m256i tail = _mm256_loadu_si256((const __m256i *)(s + n - 32));
+    s21_size_t i = 32 - (uintptr_t)d % 32;
+    if (n >= s21_stream_threshold) {
+      for (; i + 128 <= n; i += 128) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)(s + i + 64));
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)(s + i + 96));
+        _mm256_stream_si256((__m256i *)(d + i), v0);
+        _mm256_stream_si256((__m256i *)(d + i + 32), v1);
+        _mm256_stream_si256((__m256i *)(d + i + 64), v2);
+        _mm256_stream_si256((__m256i *)(d + i + 96), v3);
+      }
+      _mm_sfence();
+    }
+    for (; i + 128 <= n; i += 128) {
+      __m256i v0 = _mm256_loadu_si256((const __m256i *)(s + i));
+      __m256i v1 = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+      __m256i v2 = _mm256_loadu_si256((const __m256i *)(s + i + 64));
+      __m256i v3 = _mm256_loadu_si256((const __m256i *)(s + i + 96));
+      _mm256_store_si256((__m256i *)(d + i), v0);
+      _mm256_store_si256((__m256i *)(d + i + 32), v1);
+      _mm256_store_si256((__m256i *)(d + i + 64), v2);
+      _mm256_store_si256((__m256i *)(d + i + 96), v3);
+    }
+    for (; i + 32 <= n; i += 32)
+      _mm256_store_si256((__m256i *)(d + i),
+                         _mm256_loadu_si256((const __m256i *)(s + i)));
+    _mm256_storeu_si256((__m256i *)(d + n - 32), tail);
+    _mm256_storeu_si256((__m256i *)d, head);
+  }
+}
+
+S21_TARGET("avx512f")
+static void s21_copy_avx512(char *d, const char *s, s21_size_t n) {
+  if (n <= 64) {
+    s21_copy_avx2(d, s, n);
+  } else if (n <= 128) {
+    __m512i head = _mm512_loadu_si512((const void *)s);
+    __m512i tail = _mm512_loadu_si512((const void *)(s + n - 64));
+    _mm512_storeu_si512((void *)d, head);
+    _mm512_storeu_si512((void *)(d + n - 64), tail);
+  } else {
+    __m512i head = _mm512_loadu_si512((const void *)s);
+    __m512i tail = _mm512_loadu_si512((const void *)(s + n - 64));
+    s21_size_t i = 64 - (uintptr_t)d % 64;
+    if (n >= s21_stream_threshold) {
+      for (; i + 256 <= n; i += 256) {
+        __m512i v0 = _mm512_loadu_si512((const void *)(s + i));
+        __m512i v1 = _mm512_loadu_si512((const void *)(s + i + 64));
+        __m512i v2 = _mm512_loadu_si512((const void *)(s + i + 128));
+        __m512i v3 = _mm512_loadu_si512((const void *)(s + i + 192));
+        _mm512_stream_si512((void *)(d + i), v0);
+        _mm512_stream_si512((void *)(d + i + 64), v1);
+        _mm512_stream_si512((void *)(d + i + 128), v2);
+        _mm512_stream_si512((void *)(d + i + 192), v3);
+      }
+      _mm_sfence();
+    }
+    for (; i + 256 <= n; i += 256) {
+      __m512i v0 = _mm512_loadu_si512((const void *)(s + i));
+      __m512i v1 = _mm512_loadu_si512((const void *)(s + i + 64));
+      __m512i v2 = _mm512_loadu_si512((const void *)(s + i + 128));
+      __m512i v3 = _mm512_loadu_si512((const void *)(s + i + 192));
+      _mm512_store_si512((void *)(d + i), v0);
+      _mm512_store_si512((void *)(d + i + 64), v1);
+      _mm512_store_si512((void *)(d + i + 128), v2);
+      _mm512_store_si512((void *)(d + i + 192), v3);
+    }
+    for (; i + 64 <= n; i += 64)
+      _mm512_store_si512((void *)(d + i),
+                         _mm512_loadu_si512((const void *)(s + i)));
+    _mm512_storeu_si512((void *)(d + n - 64), tail);
+    _mm512_storeu_si512((void *)d, head);
+  }
+}
+
+#endif
+
+// BACKWARD COPY KERNELS
+
+// Mirror images of the copy kernels for s21_memmove when dest overlaps the
+// end of src: the loop walks down from an aligned end of dest, so every
+// block is loaded before the stores below it can overwrite it.
+
+static void s21_copy_back_swar(char *d, const char *s, s21_size_t n) {
+  if (n <= 16) {
+    s21_copy_small(d, s, n);
+  } else {
+    uint64_t head = S21_LOAD64(s), tail = S21_LOAD64(s + n - 8);
+    s21_size_t i = n - 1 - (uintptr_t)(d + n - 1) % 8;
+    for (; i >= 32; i -= 32) {
+      uint64_t w0 = S21_LOAD64(s + i - 8), w1 = S21_LOAD64(s + i - 16);
+      uint64_t w2 = S21_LOAD64(s + i - 24), w3 = S21_LOAD64(s + i - 32);
+      *(s21_word *)(d + i - 8) = w0;
+      *(s21_word *)(d + i - 16) = w1;
+      *(s21_word *)(d + i - 24) = w2;
+      *(s21_word *)(d + i - 32) = w3;
+    }
+    for (; i >= 8; i -= 8) *(s21_word *)(d + i - 8) = S21_LOAD64(s + i - 8);
+    S21_STORE64(d, head);
+    S21_STORE64(d + n - 8, tail);
+  }
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+static void s21_copy_back_sse2(char *d, const char *s, s21_size_t n) {
+  if (n <= 32) {
+    s21_copy_sse2(d, s, n);
+  } else {
+    __m128i head = _mm_loadu_si128((const __m128i *)s);
+    __m128i tail = _mm_loadu_si128((const __m128i *)(s + n - 16));
+    s21_size_t i = n - 1 - (uintptr_t)(d + n - 1) % 16;
+    if (n >= s21_stream_threshold) {
+      for (; i >= 64; i -= 64) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(s + i - 16));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(s + i - 32));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(s + i - 48));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(s + i - 64));
+        _mm_stream_si128((__m128i *)(d + i - 16), v0);
+        _mm_stream_si128((__m128i *)(d + i - 32), v1);
+        _mm_stream_si128((__m128i *)(d + i - 48), v2);
+        _mm_stream_si128((__m128i *)(d + i - 64), v3);
+      }
+      _mm_sfence();
+    }
+    for (; i >= 64; i -= 64) {
+      __m128i v0 = _mm_loadu_si128((const __m128i *)(s + i - 16));
+      __m128i v1 = _mm_loadu_si128((const __m128i *)(s + i - 32));
+      __m128i v2 = _mm_loadu_si128((const __m128i *)(s + i - 48));
+      __m128i v3 = _mm_loadu_si128((const __m128i *)(s + i - 64));
+      _mm_store_si128((__m128i *)(d + i - 16), v0);
+      _mm_store_si128((__m128i *)(d + i - 32), v1);
+      _mm_store_si128((__m128i *)(d + i - 48), v2);
+      _mm_store_si128((__m128i *)(d + i - 64), v3);
+    }
+    for (; i >= 16; i -= 16)
+      _mm_store_si128((__m128i *)(d + i - 16),
+                      _mm_loadu_si128((const __m128i *)(s + i - 16)));
+    _mm_storeu_si128((__m128i *)d, head);
+    _mm_storeu_si128((__m128i *)(d + n - 16), tail);
+  }
+}
+
+S21_TARGET("avx2")
+static void s21_copy_back_avx2(char *d, const char *s, s21_size_t n) {
+  if (n <= 64) {
+    s21_copy_avx2(d, s, n);
+  } else {
+    __m256i head = _mm256_loadu_si256((const __m256i *)s);
+    __m256i tail = _mm256_loadu_si256((const __m256i *)(s + n - 32));
+    s21_size_t i = n - 1 - (uintptr_t)(d + n - 1) % 32;
+    if (n >= s21_stream_threshold) {
+      for (; i >= 128; i -= 128) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(s + i - 32));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(s + i - 64));
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)(s + i - 96));
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)(s + i - 128));
+        _mm256_stream_si256((__m256i *)(d + i - 32), v0);
+        _mm256_stream_si256((__m256i *)(d + i - 64), v1);
+        _mm256_stream_si256((__m256i *)(d + i - 96), v2);
+        _mm256_stream_si256((__m256i *)(d + i - 128), v3);
+      }
+      _mm_sfence();
+    }
+    for (; i >= 128; i -= 128) {
+      __m256i v0 = _mm256_loadu_si256((const __m256i *)(s + i - 32));
+      __m256i v1 = _mm256_loadu_si256((const __m256i *)(s + i - 64));
+      __m256i v2 = _mm256_loadu_si256((const __m256i *)(s + i - 96));
+      __m256i v3 = _mm256_loadu_si256((const __m256i *)(s + i - 128));
+      _mm256_store_si256((__m256i *)(d + i - 32), v0);
+      _mm256_store_si256((__m256i *)(d + i - 64), v1);
+      _mm256_store_si256((__m256i *)(d + i - 96), v2);
+      _mm256_store_si256((__m256i *)(d + i - 128), v3);
+    }
+    for (; i >= 32; i -= 32)
+      _mm256_store_si256((__m256i *)(d + i - 32),
+                         _mm256_loadu_si256((const __m256i *)(s + i - 32)));
+    _mm256_storeu_si256((__m256i *)d, head);
+    _mm256_storeu_si256((__m256i *)(d + n - 32), tail);
+  }
+}
+
+S21_TARGET("avx512f")
+static void s21_copy_back_avx512(char *d, const char *s, s21_size_t n) {
+  if (n <= 128) {
+    s21_copy_avx512(d, s, n);
+  } else {
+    __m512i head = _mm512_loadu_si512((const void *)s);
+    __m512i tail = _mm512_loadu_si512((const void *)(s + n - 64));
+    s21_size_t i = n - 1 - (uintptr_t)(d + n - 1) % 64;
+    if (n >= s21_stream_threshold) {
+      for (; i >= 256; i -= 256) {
+        __m512i v0 = _mm512_loadu_si512((const void *)(s + i - 64));
+        __m512i v1 = _mm512_loadu_si512((const void *)(s + i - 128));
+        __m512i v2 = _mm512_loadu_si512((const void *)(s + i - 192));
+        __m512i v3 = _mm512_loadu_si512((const void *)(s + i - 256));
+        _mm512_stream_si512((void *)(d + i - 64), v0);
+        _mm512_stream_si512((void *)(d + i - 128), v1);
+        _mm512_stream_si512((void *)(d + i - 192), v2);
+        _mm512_stream_si512((void *)(d + i - 256), v3);
+      }
+      _mm_sfence();
+    }
+    for (; i >= 256; i -= 256) {
+      __m512i v0 = _mm512_loadu_si512((const void *)(s + i - 64));
+      __m512i v1 = _mm512_loadu_si512((const void *)(s + i - 128));
+      __m512i v2 = _mm512_loadu_si512((const void *)(s + i - 192));
+      __m512i v3 = _mm512_loadu_si512((const void *)(s + i - 256));
+      _mm512_store_si512((void *)(d + i - 64), v0);
+      _mm512_store_si512((void *)(d + i - 128), v1);
+      _mm512_store_si512((void *)(d + i - 192), v2);
+      _mm512_store_si512((void *)(d + i - 256), v3);
+    }
+    for (; i >= 64; i -= 64)
+      _mm512_store_si512((void *)(d + i - 64),
+                         _mm512_loadu_si512((const void *)(s + i - 64)));
+    _mm512_storeu_si512((void *)d, head);
+    _mm512_storeu_si512((void *)(d + n - 64), tail);
+  }
+}
+
+#endif
+
+// COMPARE KERNELS
+
+// The kernels find the index of the first differing byte and return the
+// difference of the two bytes as unsigned char, like the C library does.
+// Tails are compared with one last block that overlaps the bytes already
+// known to be equal.
+
+static int s21_memcmp_swar(const unsigned char *a, const unsigned char *b,
+                           s21_size_t n) {
+  s21_size_t i = 0;
+  while (i + 8 <= n && S21_LOAD64(a + i) == S21_LOAD64(b + i)) i += 8;
+  while (i < n && a[i] == b[i]) i++;
+  return i < n ? a[i] - b[i] : 0;
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+static int s21_memcmp_sse2(const unsigned char *a, const unsigned char *b,
+                           s21_size_t n) {
+  s21_size_t at = n;
+  if (n < 16) return s21_memcmp_swar(a, b, n);
+  for (s21_size_t i = 0; at == n && i < n; i += 16) {
+    if (i + 16 > n) i = n - 16;
+    unsigned mask = _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)),
+                       _mm_loadu_si128((const __m128i *)(b + i))));
+    if (mask != 0xffff) at = i + S21_CTZ(~mask);
+  }
+  return at < n ? a[at] - b[at] : 0;
+}
+
+S21_TARGET("avx2")
+static int s21_memcmp_avx2(const unsigned char *a, const unsigned char *b,
+                           s21_size_t n) {
+  s21_size_t at = n, i = 0;
+  if (n < 32) return s21_memcmp_sse2(a, b, n);
+  for (; i + 128 <= n; i += 128) {
+    __m256i e0 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                          _mm256_loadu_si256((const __m256i *)(b + i)));
+    __m256i e1 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 32)),
+                          _mm256_loadu_si256((const __m256i *)(b + i + 32)));
+    __m256i e2 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 64)),
+                          _mm256_loadu_si256((const __m256i *)(b + i + 64)));
+    __m256i e3 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i + 96)),
+                          _mm256_loadu_si256((const __m256i *)(b + i + 96)));
+    __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1),
+                                   _mm256_and_si256(e2, e3));
+    if ((unsigned)_mm256_movemask_epi8(all) != 0xffffffffu) break;
+  }
+  for (; at == n && i < n; i += 32) {
+    if (i + 32 > n) i = n - 32;
+    unsigned mask = (unsigned)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(a + i)),
+                          _mm256_loadu_si256((const __m256i *)(b + i))));
+    if (mask != 0xffffffffu) at = i + S21_CTZ(~mask);
+  }
+  return at < n ? a[at] - b[at] : 0;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static int s21_memcmp_avx512(const unsigned char *a, const unsigned char *b,
+                             s21_size_t n) {
+  s21_size_t at = n;
+  if (n < 64) return s21_memcmp_avx2(a, b, n);
+  for (s21_size_t i = 0; at == n && i < n; i += 64) {
+    if (i + 64 > n) i = n - 64;
+    uint64_t mask =
+        _mm512_cmpneq_epi8_mask(_mm512_loadu_si512((const void *)(a + i)),
+                                _mm512_loadu_si512((const void *)(b + i)));
+    if (mask) at = i + S21_CTZLL(mask);
+  }
+  return at < n ? a[at] - b[at] : 0;
+}
+
+#endif
+
+// BYTE SEARCH KERNELS
+
+// Forward search stops at the first match, which may come before the end
+// of a buffer that is shorter than n, as C11 allows. The memchr kernels
+// therefore only make aligned loads, one block or a group of four blocks
+// aligned to its size, and never load a block that starts past the match,
+// so they cannot fault on the page after it; the bytes they read outside
+// [str, str + n) are deliberate, hence S21_NO_SANITIZE. The other kernels
+// only load inside [str, str + n). A ragged end is covered by one last
+// block that overlaps bytes already known not to match, so the first (or,
+// searching backward, the last) hit is still the right one. The main loops
+// check four blocks per step with a single branch.
+
+S21_NO_SANITIZE
+static const unsigned char *s21_memchr_swar(const unsigned char *str,
+                                            unsigned char c, s21_size_t n) {
+  uint64_t pattern = S21_ONES * c;
+  s21_size_t i = 0;
+  while (i < n && (uintptr_t)(str + i) % 8 != 0 && str[i] != c) i++;
+  if ((uintptr_t)(str + i) % 8 == 0)
+    while (i < n && !S21_HASZERO(S21_LOAD64(str + i) ^ pattern)) i += 8;
+  while (i < n && str[i] != c) i++;
+  return i < n ? str + i : s21_NULL;
+}
+
+static const unsigned char *s21_memrchr_swar(const unsigned char *str,
+                                             unsigned char c, s21_size_t n) {
+  uint64_t pattern = S21_ONES * c;
+  s21_size_t i = n;
+  while (i >= 8 && !S21_HASZERO(S21_LOAD64(str + i - 8) ^ pattern)) i -= 8;
+  while (i > 0 && str[i - 1] != c) i--;
+  return i > 0 ? str + i - 1 : s21_NULL;
+}
+
+static const unsigned char *s21_memchr3_swar(const unsigned char *str,
+                                             unsigned char c1,
+                                             unsigned char c2,
+                                             unsigned char c3, s21_size_t n) {
+  uint64_t p1 = S21_ONES * c1, p2 = S21_ONES * c2, p3 = S21_ONES * c3;
+  s21_size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t w = S21_LOAD64(str + i);
+    if (S21_HASZERO(w ^ p1) | S21_HASZERO(w ^ p2) | S21_HASZERO(w ^ p3)) break;
+  }
+  while (i < n && str[i] != c1 && str[i] != c2 && str[i] != c3) i++;
+  return i < n ? str + i : s21_NULL;
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+S21_NO_SANITIZE
+static const unsigned char *s21_memchr_sse2(const unsigned char *str,
+                                            unsigned char c, s21_size_t n) {
+  const __m128i needle = _mm_set1_epi8((char)c);
+  uintptr_t off = (uintptr_t)str % 16;
+  const unsigned char *p = str - off;
+  // Offsets from the aligned block p; str + n is at end.
+  s21_size_t end = n + off < n ? (s21_size_t)-1 : n + off, i = 0;
+  if (n == 0) return s21_NULL;
+  unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                      _mm_load_si128((const __m128i *)p), needle)) &
+                  (~0u << off);
+  if (mask == 0) {
+    i = 16;
+    while (i < end && (uintptr_t)(p + i) % 64 != 0 &&
+           (mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_load_si128((const __m128i *)(p + i)), needle))) == 0)
+      i += 16;
+  }
+  if (mask == 0) {
+    for (; i < end && end - i >= 64; i += 64) {
+      __m128i e0 = _mm_cmpeq_epi8(_mm_load_si128((const __m128i *)(p + i)),
+                                  needle);
+      __m128i e1 = _mm_cmpeq_epi8(
+          _mm_load_si128((const __m128i *)(p + i + 16)), needle);
+      __m128i e2 = _mm_cmpeq_epi8(
+          _mm_load_si128((const __m128i *)(p + i + 32)), needle);
+      __m128i e3 = _mm_cmpeq_epi8(
+          _mm_load_si128((const __m128i *)(p + i + 48)), needle);
+      if (_mm_movemask_epi8(
+              _mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3))))
+        break;
+    }
+    while (i < end &&
+           (mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_load_si128((const __m128i *)(p + i)), needle))) == 0)
+      i += 16;
+  }
+  s21_size_t hit = i + (mask != 0 ? S21_CTZ(mask) : 0);
+  return mask != 0 && hit < end ? p + hit : s21_NULL;
+}
+
+S21_TARGET("sse2")
+static const unsigned char *s21_memrchr_sse2(const unsigned char *str,
+                                             unsigned char c, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m128i needle = _mm_set1_epi8((char)c);
+  s21_size_t i = n;
+  if (n < 16) return s21_memrchr_swar(str, c, n);
+  for (; i >= 64; i -= 64) {
+    __m128i e0 = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i *)(str + i - 16)), needle);
+    __m128i e1 = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i *)(str + i - 32)), needle);
+    __m128i e2 = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i *)(str + i - 48)), needle);
+    __m128i e3 = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i *)(str + i - 64)), needle);
+    if (_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3))))
+      break;
+  }
+  for (; found == s21_NULL && i > 0; i -= 16) {
+    if (i < 16) i = 16;
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i *)(str + i - 16)), needle));
+    if (mask) found = str + i - 16 + (31 - S21_CLZ(mask));
+  }
+  return found;
+}
+
+S21_TARGET("sse2")
+static const unsigned char *s21_memchr3_sse2(const unsigned char *str,
+                                             unsigned char c1,
+                                             unsigned char c2,
+                                             unsigned char c3, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m128i n1 = _mm_set1_epi8((char)c1);
+  const __m128i n2 = _mm_set1_epi8((char)c2);
+  const __m128i n3 = _mm_set1_epi8((char)c3);
+  if (n < 16) return s21_memchr3_swar(str, c1, c2, c3, n);
+  for (s21_size_t i = 0; found == s21_NULL && i < n; i += 16) {
+    if (i + 16 > n) i = n - 16;
+    __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+    __m128i eq = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, n1), _mm_cmpeq_epi8(v, n2)),
+        _mm_cmpeq_epi8(v, n3));
+    unsigned mask = _mm_movemask_epi8(eq);
+    if (mask) found = str + i + S21_CTZ(mask);
+  }
+  return found;
+}
+
+S21_TARGET("avx2")
+S21_NO_SANITIZE
+static const unsigned char *s21_memchr_avx2(const unsigned char *str,
+                                            unsigned char c, s21_size_t n) {
+  const __m256i needle = _mm256_set1_epi8((char)c);
+  uintptr_t off = (uintptr_t)str % 32;
+  const unsigned char *p = str - off;
+  s21_size_t end = n + off < n ? (s21_size_t)-1 : n + off, i = 0;
+  if (n == 0) return s21_NULL;
+  unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                      _mm256_load_si256((const __m256i *)p), needle)) &
+                  (~0u << off);
+  if (mask == 0) {
+    i = 32;
+    while (i < end && (uintptr_t)(p + i) % 128 != 0 &&
+           (mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_load_si256((const __m256i *)(p + i)), needle))) == 0)
+      i += 32;
+  }
+  if (mask == 0) {
+    for (; i < end && end - i >= 128; i += 128) {
+      __m256i e0 = _mm256_cmpeq_epi8(
+          _mm256_load_si256((const __m256i *)(p + i)), needle);
+      __m256i e1 = _mm256_cmpeq_epi8(
+          _mm256_load_si256((const __m256i *)(p + i + 32)), needle);
+      __m256i e2 = _mm256_cmpeq_epi8(
+          _mm256_load_si256((const __m256i *)(p + i + 64)), needle);
+      __m256i e3 = _mm256_cmpeq_epi8(
+          _mm256_load_si256((const __m256i *)(p + i + 96)), needle);
+      if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(e0, e1),
+                                               _mm256_or_si256(e2, e3))))
+        break;
+    }
+    while (i < end &&
+           (mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_load_si256((const __m256i *)(p + i)), needle))) == 0)
+      i += 32;
+  }
+  s21_size_t hit = i + (mask != 0 ? S21_CTZ(mask) : 0);
+  return mask != 0 && hit < end ? p + hit : s21_NULL;
+}
+
+S21_TARGET("avx2")
+static const unsigned char *s21_memrchr_avx2(const unsigned char *str,
+                                             unsigned char c, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m256i needle = _mm256_set1_epi8((char)c);
+  s21_size_t i = n;
+  if (n < 32) return s21_memrchr_sse2(str, c, n);
+  for (; i >= 128; i -= 128) {
+    __m256i e0 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256((const __m256i *)(str + i - 32)), needle);
+    __m256i e1 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256((const __m256i *)(str + i - 64)), needle);
+    __m256i e2 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256((const __m256i *)(str + i - 96)), needle);
+    __m256i e3 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256((const __m256i *)(str + i - 128)), needle);
+    if (_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3))))
+      break;
+  }
+  for (; found == s21_NULL && i > 0; i -= 32) {
+    if (i < 32) i = 32;
+    unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+        _mm256_loadu_si256((const __m256i *)(str + i - 32)), needle));
+    if (mask) found = str + i - 32 + (31 - S21_CLZ(mask));
+  }
+  return found;
+}
+
+S21_TARGET("avx2")
+static const unsigned char *s21_memchr3_avx2(const unsigned char *str,
+                                             unsigned char c1,
+                                             unsigned char c2,
+                                             unsigned char c3, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m256i n1 = _mm256_set1_epi8((char)c1);
+  const __m256i n2 = _mm256_set1_epi8((char)c2);
+  const __m256i n3 = _mm256_set1_epi8((char)c3);
+  s21_size_t i = 0;
+  if (n < 32) return s21_memchr3_sse2(str, c1, c2, c3, n);
+  for (; i + 64 <= n; i += 64) {
+    __m256i v0 = _mm256_loadu_si256((const __m256i *)(str + i));
+    __m256i v1 = _mm256_loadu_si256((const __m256i *)(str + i + 32));
+    __m256i e0 = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v0, n1), _mm256_cmpeq_epi8(v0, n2)),
+        _mm256_cmpeq_epi8(v0, n3));
+    __m256i e1 = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v1, n1), _mm256_cmpeq_epi8(v1, n2)),
+        _mm256_cmpeq_epi8(v1, n3));
+    if (_mm256_movemask_epi8(_mm256_or_si256(e0, e1))) break;
+  }
+  for (; found == s21_NULL && i < n; i += 32) {
+    if (i + 32 > n) i = n - 32;
+    __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+    __m256i eq = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, n1), _mm256_cmpeq_epi8(v, n2)),
+        _mm256_cmpeq_epi8(v, n3));
+    unsigned mask = (unsigned)_mm256_movemask_epi8(eq);
+    if (mask) found = str + i + S21_CTZ(mask);
+  }
+  return found;
+}
+
+S21_TARGET("avx512f,avx512bw")
+S21_NO_SANITIZE
+static const unsigned char *s21_memchr_avx512(const unsigned char *str,
+                                              unsigned char c, s21_size_t n) {
+  const __m512i needle = _mm512_set1_epi8((char)c);
+  uintptr_t off = (uintptr_t)str % 64;
+  const unsigned char *p = str - off;
+  s21_size_t end = n + off < n ? (s21_size_t)-1 : n + off, i = 0;
+  if (n == 0) return s21_NULL;
+  uint64_t mask =
+      _mm512_cmpeq_epi8_mask(_mm512_load_si512((const void *)p), needle) &
+      (~0ULL << off);
+  if (mask == 0) {
+    i = 64;
+    while (i < end && (uintptr_t)(p + i) % 256 != 0 &&
+           (mask = _mm512_cmpeq_epi8_mask(
+                _mm512_load_si512((const void *)(p + i)), needle)) == 0)
+      i += 64;
+  }
+  if (mask == 0) {
+    for (; i < end && end - i >= 256; i += 256) {
+      __m512i v0 = _mm512_load_si512((const void *)(p + i));
+      __m512i v1 = _mm512_load_si512((const void *)(p + i + 64));
+      __m512i v2 = _mm512_load_si512((const void *)(p + i + 128));
+      __m512i v3 = _mm512_load_si512((const void *)(p + i + 192));
+      uint64_t m = _mm512_cmpeq_epi8_mask(v0, needle) |
+                   _mm512_cmpeq_epi8_mask(v1, needle) |
+                   _mm512_cmpeq_epi8_mask(v2, needle) |
+                   _mm512_cmpeq_epi8_mask(v3, needle);
+      if (m) break;
+    }
+    while (i < end &&
+           (mask = _mm512_cmpeq_epi8_mask(
+                _mm512_load_si512((const void *)(p + i)), needle)) == 0)
+      i += 64;
+  }
+  s21_size_t hit = i + (mask != 0 ? S21_CTZLL(mask) : 0);
+  return mask != 0 && hit < end ? p + hit : s21_NULL;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static const unsigned char *s21_memrchr_avx512(const unsigned char *str,
+                                               unsigned char c, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m512i needle = _mm512_set1_epi8((char)c);
+  s21_size_t i = n;
+  if (n < 64) return s21_memrchr_avx2(str, c, n);
+  for (; i >= 256; i -= 256) {
+    __m512i v0 = _mm512_loadu_si512((const void *)(str + i - 64));
+    __m512i v1 = _mm512_loadu_si512((const void *)(str + i - 128));
+    __m512i v2 = _mm512_loadu_si512((const void *)(str + i - 192));
+    __m512i v3 = _mm512_loadu_si512((const void *)(str + i - 256));
+    uint64_t m = _mm512_cmpeq_epi8_mask(v0, needle) |
+                 _mm512_cmpeq_epi8_mask(v1, needle) |
+                 _mm512_cmpeq_epi8_mask(v2, needle) |
+                 _mm512_cmpeq_epi8_mask(v3, needle);
+    if (m) break;
+  }
+  for (; found == s21_NULL && i > 0; i -= 64) {
+    if (i < 64) i = 64;
+    uint64_t mask = _mm512_cmpeq_epi8_mask(
+        _mm512_loadu_si512((const void *)(str + i - 64)), needle);
+    if (mask) found = str + i - 64 + (63 - S21_CLZLL(mask));
+  }
+  return found;
+}
+
+#endif
+
+// PAIR SEARCH KERNELS
+
+// Candidate filter for substring search: the first i < n with
+// str[i] == c1 and str[i + gap] == c2. The kernels read
+// [str, str + n + gap) and nothing else; a ragged end is covered by one
+// last overlapping block like in the byte search kernels.
+
+static const unsigned char *s21_pair_swar(const unsigned char *str,
+                                          unsigned char c1, unsigned char c2,
+                                          s21_size_t gap, s21_size_t n) {
+  uint64_t p1 = S21_ONES * c1, p2 = S21_ONES * c2;
+  s21_size_t i = 0;
+  for (; i < n; i++) {
+    while (i + 8 <= n &&
+           !S21_HASZERO((S21_LOAD64(str + i) ^ p1) |
+                        (S21_LOAD64(str + i + gap) ^ p2)))
+      i += 8;
+    if (i < n && str[i] == c1 && str[i + gap] == c2) break;
+  }
+  return i < n ? str + i : s21_NULL;
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+static const unsigned char *s21_pair_sse2(const unsigned char *str,
+                                          unsigned char c1, unsigned char c2,
+                                          s21_size_t gap, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m128i n1 = _mm_set1_epi8((char)c1);
+  const __m128i n2 = _mm_set1_epi8((char)c2);
+  if (n < 16) return s21_pair_swar(str, c1, c2, gap, n);
+  for (s21_size_t i = 0; found == s21_NULL && i < n; i += 16) {
+    if (i + 16 > n) i = n - 16;
+    __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(str + i)),
+                                n1);
+    __m128i e2 = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i *)(str + i + gap)), n2);
+    unsigned mask = _mm_movemask_epi8(_mm_and_si128(e1, e2));
+    if (mask) found = str + i + S21_CTZ(mask);
+  }
+  return found;
+}
+
+S21_TARGET("avx2")
+static const unsigned char *s21_pair_avx2(const unsigned char *str,
+                                          unsigned char c1, unsigned char c2,
+                                          s21_size_t gap, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m256i n1 = _mm256_set1_epi8((char)c1);
+  const __m256i n2 = _mm256_set1_epi8((char)c2);
+  s21_size_t i = 0;
+  if (n < 32) return s21_pair_sse2(str, c1, c2, gap, n);
+  for (; i + 64 <= n; i += 64) {
+    __m256i e0 = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(str + i)), n1),
+        _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *)(str + i + gap)), n2));
+    __m256i e1 = _mm256_and_si256(
+        _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *)(str + i + 32)), n1),
+        _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *)(str + i + gap + 32)), n2));
+    if (_mm256_movemask_epi8(_mm256_or_si256(e0, e1))) break;
+  }
+  for (; found == s21_NULL && i < n; i += 32) {
+    if (i + 32 > n) i = n - 32;
+    __m256i e = _mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(str + i)), n1),
+        _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *)(str + i + gap)), n2));
+    unsigned mask = (unsigned)_mm256_movemask_epi8(e);
+    if (mask) found = str + i + S21_CTZ(mask);
+  }
+  return found;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static const unsigned char *s21_pair_avx512(const unsigned char *str,
+                                            unsigned char c1, unsigned char c2,
+                                            s21_size_t gap, s21_size_t n) {
+  const unsigned char *found = s21_NULL;
+  const __m512i n1 = _mm512_set1_epi8((char)c1);
+  const __m512i n2 = _mm512_set1_epi8((char)c2);
+  if (n < 64) return s21_pair_avx2(str, c1, c2, gap, n);
+  for (s21_size_t i = 0; found == s21_NULL && i < n; i += 64) {
+    if (i + 64 > n) i = n - 64;
+    uint64_t mask = _mm512_mask_cmpeq_epi8_mask(
+        _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void *)(str + i)),
+                               n1),
+        _mm512_loadu_si512((const void *)(str + i + gap)), n2);
+    if (mask) found = str + i + S21_CTZLL(mask);
+  }
+  return found;
+}
+
+#endif
+
+// TEDDY KERNELS
+
+// Candidate filter of multi-pattern search. Each of the first len bytes at
+// a position is split into nibbles, each nibble looks up a byte of bucket
+// bits with pshufb, and the lookups are ANDed; a nonzero result marks a
+// position where some pattern of those buckets may start. Positions are
+// classified 64 at a time. Like the pair kernels they read
+// [str, str + n + len - 1) only.
+
+static uint64_t s21_teddy_scalar(const s21_teddy *t, const unsigned char *str,
+                                 s21_size_t n, s21_size_t *pos,
+                                 unsigned char *buckets) {
+  uint64_t mask = 0;
+  for (s21_size_t i = *pos; mask == 0 && i < n; i += 64) {
+    *pos = i;
+    for (s21_size_t k = 0; k < 64 && i + k < n; k++) {
+      unsigned bits = 0xff;
+      for (int j = 0; j < t->len; j++) {
+        bits &= t->lo[j][str[i + k + j] & 15] & t->hi[j][str[i + k + j] >> 4];
+      }
+      buckets[k] = (unsigned char)bits;
+      if (bits) mask |= 1ULL << k;
+    }
+  }
+  return mask;
+}
+
+#if S21_X86
+
+S21_TARGET("avx2")
+static inline __m256i s21_teddy_classify_avx2(const s21_teddy *t,
+                                              const __m256i *lo,
+                                              const __m256i *hi,
+                                              const unsigned char *str) {
+  const __m256i low4 = _mm256_set1_epi8(15);
+  __m256i res = _mm256_set1_epi8(-1);
+  for (int j = 0; j < t->len; j++) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(str + j));
+    __m256i l = _mm256_shuffle_epi8(lo[j], _mm256_and_si256(v, low4));
+    __m256i h = _mm256_shuffle_epi8(
+        hi[j], _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+    res = _mm256_and_si256(res, _mm256_and_si256(l, h));
+  }
+  return res;
+}
+
+S21_TARGET("avx2")
+static uint64_t s21_teddy_avx2(const s21_teddy *t, const unsigned char *str,
+                               s21_size_t n, s21_size_t *pos,
+                               unsigned char *buckets) {
+  uint64_t mask = 0;
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i lo[3], hi[3];
+  if (n - *pos < 64) return s21_teddy_scalar(t, str, n, pos, buckets);
+  for (int j = 0; j < t->len; j++) {
+    lo[j] = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)t->lo[j]));
+    hi[j] = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)t->hi[j]));
+  }
+  for (s21_size_t i = *pos; mask == 0 && i < n; i += 64) {
+    // A ragged end moves the last block back; positions below i were
+    // already reported.
+    s21_size_t b = i + 64 > n ? n - 64 : i;
+    __m256i r0 = s21_teddy_classify_avx2(t, lo, hi, str + b);
+    __m256i r1 = s21_teddy_classify_avx2(t, lo, hi, str + b + 32);
+    uint64_t m0 = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r0, zero));
+    uint64_t m1 = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r1, zero));
+    mask = ~(m0 | m1 << 32) & (~0ULL << (i - b));
+    if (mask) {
+      _mm256_storeu_si256((__m256i *)buckets, r0);
+      _mm256_storeu_si256((__m256i *)(buckets + 32), r1);
+      *pos = b;
+    }
+  }
+  return mask;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static uint64_t s21_teddy_avx512(const s21_teddy *t, const unsigned char *str,
+                                 s21_size_t n, s21_size_t *pos,
+                                 unsigned char *buckets) {
+  uint64_t mask = 0;
+  const __m512i low4 = _mm512_set1_epi8(15);
+  __m512i lo[3], hi[3];
+  if (n - *pos < 64) return s21_teddy_scalar(t, str, n, pos, buckets);
+  for (int j = 0; j < t->len; j++) {
+    lo[j] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)t->lo[j]));
+    hi[j] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)t->hi[j]));
+  }
+  for (s21_size_t i = *pos; mask == 0 && i < n; i += 64) {
+    s21_size_t b = i + 64 > n ? n - 64 : i;
+    __m512i res = _mm512_set1_epi8(-1);
+    for (int j = 0; j < t->len; j++) {
+      __m512i v = _mm512_loadu_si512((const void *)(str + b + j));
+      __m512i l = _mm512_shuffle_epi8(lo[j], _mm512_and_si512(v, low4));
+      __m512i h = _mm512_shuffle_epi8(
+          hi[j], _mm512_and_si512(_mm512_srli_epi16(v, 4), low4));
+      res = _mm512_and_si512(res, _mm512_and_si512(l, h));
+    }
+    mask = _mm512_test_epi8_mask(res, res) & (~0ULL << (i - b));
+    if (mask) {
+      _mm512_storeu_si512((void *)buckets, res);
+      *pos = b;
+    }
+  }
+  return mask;
+}
+
+#endif
+
+// FILL KERNELS
+
+// s21_set_* follow the copy kernels: overlapping head and tail stores, an
+// aligned main loop and non-temporal stores for large clears. s21_fill16_*
+// repeat a 16-byte pattern with unaligned stores at multiples of 16 from
+// dest, so every store starts at the same phase of the pattern.
+
+static void s21_set_small(char *d, uint64_t w, s21_size_t n) {
+  if (n >= 8) {
+    S21_STORE64(d, w);
+    S21_STORE64(d + n - 8, w);
+  } else if (n >= 4) {
+    S21_STORE32(d, (uint32_t)w);
+    S21_STORE32(d + n - 4, (uint32_t)w);
+  } else if (n >= 2) {
+    S21_STORE16(d, (uint16_t)w);
+    S21_STORE16(d + n - 2, (uint16_t)w);
+  } else if (n == 1) {
+    *d = (char)w;
+  }
+}
+
+static void s21_set_swar(char *d, unsigned char c, s21_size_t n) {
+  uint64_t w = S21_ONES * c;
+  if (n <= 16) {
+    s21_set_small(d, w, n);
+  } else {
+    S21_STORE64(d, w);
+    S21_STORE64(d + n - 8, w);
+    for (s21_size_t i = 8 - (uintptr_t)d % 8; i + 8 <= n; i += 8)
+      *(s21_word *)(d + i) = w;
+  }
+}
+
+static void s21_fill16_swar(char *d, const unsigned char *pattern,
+                            s21_size_t n) {
+  uint64_t lo = S21_LOAD64(pattern), hi = S21_LOAD64(pattern + 8);
+  s21_size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    S21_STORE64(d + i, lo);
+    S21_STORE64(d + i + 8, hi);
+  }
+  for (; i < n; i++) d[i] = (char)pattern[i % 16];
+}
+
+#if S21_X86
+
+S21_TARGET("sse2")
+static void s21_set_sse2(char *d, unsigned char c, s21_size_t n) {
+  const __m128i v = _mm_set1_epi8((char)c);
+  if (n <= 16) {
+    s21_set_small(d, S21_ONES * c, n);
+  } else if (n <= 32) {
+    _mm_storeu_si128((__m128i *)d, v);
+    _mm_storeu_si128((__m128i *)(d + n - 16), v);
+  } else {
+    s21_size_t i = 16 - (uintptr_t)d % 16;
+    _mm_storeu_si128((__m128i *)d, v);
+    _mm_storeu_si128((__m128i *)(d + n - 16), v);
+    if (n >= s21_stream_threshold) {
+      for (; i + 64 <= n; i += 64) {
+        _mm_stream_si128((__m128i *)(d + i), v);
+        _mm_stream_si128((__m128i *)(d + i + 16), v);
+        _mm_stream_si128((__m128i *)(d + i + 32), v);
+        _mm_stream_si128((__m128i *)(d + i + 48), v);
+      }
+      _mm_sfence();
+    }
+    for (; i + 64 <= n; i += 64) {
+      _mm_store_si128((__m128i *)(d + i), v);
+      _mm_store_si128((__m128i *)(d + i + 16), v);
+      _mm_store_si128((__m128i *)(d + i + 32), v);
+      _mm_store_si128((__m128i *)(d + i + 48), v);
+    }
+    for (; i + 16 <= n; i += 16) _mm_store_si128((__m128i *)(d + i), v);
+  }
+}
+
+S21_TARGET("sse2")
+static void s21_fill16_sse2(char *d, const unsigned char *pattern,
+                            s21_size_t n) {
+  const __m128i v = _mm_loadu_si128((const __m128i *)pattern);
+  s21_size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    _mm_storeu_si128((__m128i *)(d + i), v);
+    _mm_storeu_si128((__m128i *)(d + i + 16), v);
+    _mm_storeu_si128((__m128i *)(d + i + 32), v);
+    _mm_storeu_si128((__m128i *)(d + i + 48), v);
+  }
+  for (; i + 16 <= n; i += 16) _mm_storeu_si128((__m128i *)(d + i), v);
+  for (; i < n; i++) d[i] = (char)pattern[i % 16];
+}
+
+S21_TARGET("avx2")
+static void s21_set_avx2(char *d, unsigned char c, s21_size_t n) {
+  const __m256i v = _mm256_set1_epi8((char)c);
+  if (n <= 32) {
+    s21_set_sse2(d, c, n);
+  } else if (n <= 64) {
+    _mm256_storeu_si256((__m256i *)d, v);
+    _mm256_storeu_si256((__m256i *)(d + n - 32), v);
+  } else {
+    s21_size_t i = 32 - (uintptr_t)d % 32;
+    _mm256_storeu_si256((__m256i *)d, v);
+    _mm256_storeu_si256((__m256i *)(d + n - 32), v);
+    if (n >= s21_stream_threshold) {
+      for (; i + 128 <= n; i += 128) {
+        _mm256_stream_si256((__m256i *)(d + i), v);
+        _mm256_stream_si256((__m256i *)(d + i + 32), v);
+        _mm256_stream_si256((__m256i *)(d + i + 64), v);
+        _mm256_stream_si256((__m256i *)(d + i + 96), v);
+      }
+      _mm_sfence();
+    }
+    for (; i + 128 <= n; i += 128) {
+      _mm256_store_si256((__m256i *)(d + i), v);
+      _mm256_store_si256((__m256i *)(d + i + 32), v);
+      _mm256_store_si256((__m256i *)(d + i + 64), v);
+      _mm256_store_si256((__m256i *)(d + i + 96), v);
+    }
+    for (; i + 32 <= n; i += 32) _mm256_store_si256((__m256i *)(d + i), v);
+  }
+}
+
+S21_TARGET("avx2")
+static void s21_fill16_avx2(char *d, const unsigned char *pattern,
+                            s21_size_t n) {
+  const __m256i v =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)pattern));
+  s21_size_t i = 0;
+  for (; i + 128 <= n; i += 128) {
+    _mm256_storeu_si256((__m256i *)(d + i), v);
+    _mm256_storeu_si256((__m256i *)(d + i + 32), v);
+    _mm256_storeu_si256((__m256i *)(d + i + 64), v);
+    _mm256_storeu_si256((__m256i *)(d + i + 96), v);
+  }
+  for (; i + 32 <= n; i += 32) _mm256_storeu_si256((__m256i *)(d + i), v);
+  s21_fill16_sse2(d + i, pattern, n - i);
+}
+
+S21_TARGET("avx512f")
+static void s21_set_avx512(char *d, unsigned char c, s21_size_t n) {
+  const __m512i v = _mm512_set1_epi8((char)c);
+  if (n <= 64) {
+    s21_set_avx2(d, c, n);
+  } else if (n <= 128) {
+    _mm512_storeu_si512((void *)d, v);
+    _mm512_storeu_si512((void *)(d + n - 64), v);
+  } else {
+    s21_size_t i = 64 - (uintptr_t)d % 64;
+    _mm512_storeu_si512((void *)d, v);
+    _mm512_storeu_si512((void *)(d + n - 64), v);
+    if (n >= s21_stream_threshold) {
+      for (; i + 256 <= n; i += 256) {
+        _mm512_stream_si512((void *)(d + i), v);
+        _mm512_stream_si512((void *)(d + i + 64), v);
+        _mm512_stream_si512((void *)(d + i + 128), v);
+        _mm512_stream_si512((void *)(d + i + 192), v);
+      }
+      _mm_sfence();
+    }
+    for (; i + 256 <= n; i += 256) {
+      _mm512_store_si512((void *)(d + i), v);
+      _mm512_store_si512((void *)(d + i + 64), v);
+      _mm512_store_si512((void *)(d + i + 128), v);
+      _mm512_store_si512((void *)(d + i + 192), v);
+    }
+    for (; i + 64 <= n; i += 64) _mm512_store_si512((void *)(d + i), v);
+  }
+}
+
+S21_TARGET("avx512f")
+static void s21_fill16_avx512(char *d, const unsigned char *pattern,
+                              s21_size_t n) {
+  const __m512i v =
+      _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)pattern));
+  s21_size_t i = 0;
+  for (; i + 256 <= n; i += 256) {
+    _mm512_storeu_si512((void *)(d + i), v);
+    _mm512_storeu_si512((void *)(d + i + 64), v);
+    _mm512_storeu_si512((void *)(d + i + 128), v);
+    _mm512_storeu_si512((void *)(d + i + 192), v);
+  }
+  for (; i + 64 <= n; i += 64) _mm512_storeu_si512((void *)(d + i), v);
+  s21_fill16_avx2(d + i, pattern, n - i);
+}
+
+#endif
+
+// BYTE SET KERNELS
+
+// The vector kernels classify a whole block at once, whatever the size of
+// the set: two pshufb lookups on the low nibble fetch the rows for high
+// nibbles 0-7 and 8-15, the sign bit of the byte picks one of them, and a
+// third lookup turns the high nibble into the bit to test. Like strlen,
+// the kernels for C strings only read aligned blocks, over-reading on
+// purpose under S21_NO_SANITIZE; the kernels for buffers of known length
+// stay inside the buffer and cover a ragged end with one overlapping block.
+
+void s21_byteset_add(s21_byteset *set, unsigned char c) {
+  set->bits[c >> 6] |= 1ULL << (c & 63);
+  set->rows[(c & 15) + (c >> 7) * 16] |= (unsigned char)(1 << ((c >> 4) & 7));
+}
+
+void s21_byteset_init(s21_byteset *set, const char *chars, int with_nul) {
+  for (int i = 0; i < 4; i++) set->bits[i] = 0;
+  for (int i = 0; i < 32; i++) set->rows[i] = 0;
+  for (const char *c = chars; *c; c++) s21_byteset_add(set, (unsigned char)*c);
+  if (with_nul) s21_byteset_add(set, '\0');
+}
+
+static s21_size_t s21_span_scalar(const unsigned char *str,
+                                  const s21_byteset *set, int accept) {
+  s21_size_t i = 0;
+  while (S21_BYTESET_HAS(set, str[i]) == accept) i++;
+  return i;
+}
+
+static s21_size_t s21_span_n_scalar(const unsigned char *str, s21_size_t n,
+                                    const s21_byteset *set, int accept) {
+  s21_size_t i = 0;
+  while (i < n && S21_BYTESET_HAS(set, str[i]) == accept) i++;
+  return i;
+}
+
+// Split kernels classify 64 bytes into a mask of delimiter positions and
+// turn the mask into field boundaries the way simdjson indexes structural
+// characters: the positions are extracted four at a time with no branch
+// per bit, then each one closes the field that started after the last.
+
+static S21_INLINE s21_size_t s21_split_mask(const unsigned char *str,
+                                            uint64_t mask, s21_size_t base,
+                                            s21_size_t *start,
+                                            s21_span_t *spans,
+                                            s21_size_t count, s21_size_t max) {
+  s21_size_t pos[64];
+  int cnt = S21_POPCOUNTLL(mask);
+  // Bit 63 keeps ctz defined once mask runs out; those slots are unused.
+  for (int k = 0; k < cnt; k += 4) {
+    pos[k] = base + S21_CTZLL(mask | 1ULL << 63);
+    mask &= mask - 1;
+    pos[k + 1] = base + S21_CTZLL(mask | 1ULL << 63);
+    mask &= mask - 1;
+    pos[k + 2] = base + S21_CTZLL(mask | 1ULL << 63);
+    mask &= mask - 1;
+    pos[k + 3] = base + S21_CTZLL(mask | 1ULL << 63);
+    mask &= mask - 1;
+  }
+  if (count + cnt + 3 <= max) {
+    // Room for the spare slots: whole groups of four, no branch per field.
+    s21_size_t prev = *start;
+    for (int k = 0; k < cnt; k += 4) {
+      for (int j = k; j < k + 4; j++) {
+        spans[count + j].ptr = (const char *)str + prev;
+        spans[count + j].len = pos[j] - prev;
+        prev = pos[j] + 1;
+      }
+    }
+    if (cnt) *start = pos[cnt - 1] + 1;
+    count += cnt;
+  } else {
+    for (int k = 0; k < cnt; k++, count++) {
+      if (count < max) {
+        spans[count].ptr = (const char *)str + *start;
+        spans[count].len = pos[k] - *start;
+      }
+      *start = pos[k] + 1;
+    }
+  }
+  return count;
+}
+
+static s21_size_t s21_split_scalar(const unsigned char *str, s21_size_t n,
+                                   const s21_byteset *set, s21_span_t *spans,
+                                   s21_size_t max) {
+  s21_size_t count = 0, start = 0;
+  for (s21_size_t i = 0; i < n; i += 64) {
+    uint64_t mask = 0;
+    for (s21_size_t k = 0; k < 64 && i + k < n; k++) {
+      mask |= (uint64_t)S21_BYTESET_HAS(set, str[i + k]) << k;
+    }
+    count = s21_split_mask(str, mask, i, &start, spans, count, max);
+  }
+  if (count < max) {
+    spans[count].ptr = (const char *)str + start;
+    spans[count].len = n - start;
+  }
+  return count + 1;
+}
+
+#if S21_X86
+
+S21_TARGET("avx2")
+static inline unsigned s21_classify_avx2(__m256i v, __m256i rows_lo,
+                                         __m256i rows_hi, __m256i bits) {
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(v, nibble);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+  __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(rows_lo, lo),
+                                   _mm256_shuffle_epi8(rows_hi, lo), v);
+  __m256i bit = _mm256_shuffle_epi8(bits, hi);
+  return (unsigned)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit));
+}
+
+S21_TARGET("avx2")
+S21_NO_SANITIZE
+static s21_size_t s21_span_avx2(const unsigned char *str,
+                                const s21_byteset *set, int accept) {
+  const __m256i rows_lo = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->rows));
+  const __m256i rows_hi = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)(set->rows + 16)));
+  const __m256i bits = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8,
+      16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  unsigned flip = accept ? 0xffffffffu : 0;
+  uintptr_t off = (uintptr_t)str % 32;
+  const unsigned char *p = str - off;
+  unsigned stop =
+      (s21_classify_avx2(_mm256_load_si256((const __m256i *)p), rows_lo,
+                         rows_hi, bits) ^
+       flip) >>
+      off;
+  if (stop == 0) {
+    do {
+      p += 32;
+      stop = s21_classify_avx2(_mm256_load_si256((const __m256i *)p), rows_lo,
+                               rows_hi, bits) ^
+             flip;
+    } while (stop == 0);
+    off = 0;
+  }
+  return (p + off + S21_CTZ(stop)) - str;
+}
+
+S21_TARGET("avx2")
+static s21_size_t s21_span_n_avx2(const unsigned char *str, s21_size_t n,
+                                  const s21_byteset *set, int accept) {
+  const __m256i rows_lo = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->rows));
+  const __m256i rows_hi = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)(set->rows + 16)));
+  const __m256i bits = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8,
+      16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  unsigned flip = accept ? 0xffffffffu : 0;
+  s21_size_t len = n;
+  if (n < 32) return s21_span_n_scalar(str, n, set, accept);
+  for (s21_size_t i = 0; len == n && i < n; i += 32) {
+    if (i + 32 > n) i = n - 32;
+    unsigned stop =
+        s21_classify_avx2(_mm256_loadu_si256((const __m256i *)(str + i)),
+                          rows_lo, rows_hi, bits) ^
+        flip;
+    if (stop) len = i + S21_CTZ(stop);
+  }
+  return len;
+}
+
+S21_TARGET("avx2")
+static s21_size_t s21_split_avx2(const unsigned char *str, s21_size_t n,
+                                 const s21_byteset *set, s21_span_t *spans,
+                                 s21_size_t max) {
+  const __m256i rows_lo = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->rows));
+  const __m256i rows_hi = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)(set->rows + 16)));
+  const __m256i bits = _mm256_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8,
+      16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  s21_size_t count = 0, start = 0;
+  if (n < 64) return s21_split_scalar(str, n, set, spans, max);
+  for (s21_size_t i = 0; i < n; i += 64) {
+    // A ragged end moves the last block back and drops the bytes that
+    // were already split.
+    s21_size_t b = i + 64 > n ? n - 64 : i;
+    uint64_t lo = s21_classify_avx2(
+        _mm256_loadu_si256((const __m256i *)(str + b)), rows_lo, rows_hi, bits);
+    uint64_t hi = s21_classify_avx2(
+        _mm256_loadu_si256((const __m256i *)(str + b + 32)), rows_lo, rows_hi,
+        bits);
+    uint64_t mask = (lo | hi << 32) & (~0ULL << (i - b));
+    count = s21_split_mask(str, mask, b, &start, spans, count, max);
+  }
+  if (count < max) {
+    spans[count].ptr = (const char *)str + start;
+    spans[count].len = n - start;
+  }
+  return count + 1;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static inline uint64_t s21_classify_avx512(__m512i v, __m512i rows_lo,
+                                           __m512i rows_hi, __m512i bits) {
+  const __m512i nibble = _mm512_set1_epi8(0x0f);
+  __m512i lo = _mm512_and_si512(v, nibble);
+  __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble);
+  __m512i row = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v),
+                                       _mm512_shuffle_epi8(rows_lo, lo),
+                                       _mm512_shuffle_epi8(rows_hi, lo));
+  __m512i bit = _mm512_shuffle_epi8(bits, hi);
+  return _mm512_cmpeq_epi8_mask(_mm512_and_si512(row, bit), bit);
+}
+
+S21_TARGET("avx512f,avx512bw")
+S21_NO_SANITIZE
+static s21_size_t s21_span_avx512(const unsigned char *str,
+                                  const s21_byteset *set, int accept) {
+  const __m512i rows_lo =
+      _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)set->rows));
+  const __m512i rows_hi = _mm512_broadcast_i32x4(
+      _mm_loadu_si128((const __m128i *)(set->rows + 16)));
+  const __m512i bits = _mm512_broadcast_i32x4(_mm_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+  uint64_t flip = accept ? ~0ULL : 0;
+  uintptr_t off = (uintptr_t)str % 64;
+  const unsigned char *p = str - off;
+  uint64_t stop = (s21_classify_avx512(_mm512_load_si512((const void *)p),
+                                       rows_lo, rows_hi, bits) ^
+                   flip) >>
+                  off;
+  if (stop == 0) {
+    do {
+      p += 64;
+      stop = s21_classify_avx512(_mm512_load_si512((const void *)p), rows_lo,
+                                 rows_hi, bits) ^
+             flip;
+    } while (stop == 0);
+    off = 0;
+  }
+  return (p + off + S21_CTZLL(stop)) - str;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static s21_size_t s21_span_n_avx512(const unsigned char *str, s21_size_t n,
+                                    const s21_byteset *set, int accept) {
+  const __m512i rows_lo =
+      _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)set->rows));
+  const __m512i rows_hi = _mm512_broadcast_i32x4(
+      _mm_loadu_si128((const __m128i *)(set->rows + 16)));
+  const __m512i bits = _mm512_broadcast_i32x4(_mm_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+  uint64_t flip = accept ? ~0ULL : 0;
+  s21_size_t len = n;
+  if (n < 64) return s21_span_n_avx2(str, n, set, accept);
+  for (s21_size_t i = 0; len == n && i < n; i += 64) {
+    if (i + 64 > n) i = n - 64;
+    uint64_t stop =
+        s21_classify_avx512(_mm512_loadu_si512((const void *)(str + i)),
+                            rows_lo, rows_hi, bits) ^
+        flip;
+    if (stop) len = i + S21_CTZLL(stop);
+  }
+  return len;
+}
+
+S21_TARGET("avx512f,avx512bw")
+static s21_size_t s21_split_avx512(const unsigned char *str, s21_size_t n,
+                                   const s21_byteset *set, s21_span_t *spans,
+                                   s21_size_t max) {
+  const __m512i rows_lo =
+      _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)set->rows));
+  const __m512i rows_hi = _mm512_broadcast_i32x4(
+      _mm_loadu_si128((const __m128i *)(set->rows + 16)));
+  const __m512i bits = _mm512_broadcast_i32x4(_mm_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+  s21_size_t count = 0, start = 0;
+  if (n < 64) return s21_split_scalar(str, n, set, spans, max);
+  for (s21_size_t i = 0; i < n; i += 64) {
+    s21_size_t b = i + 64 > n ? n - 64 : i;
+    uint64_t mask =
+        s21_classify_avx512(_mm512_loadu_si512((const void *)(str + b)),
+                            rows_lo, rows_hi, bits) &
+        (~0ULL << (i - b));
+    count = s21_split_mask(str, mask, b, &start, spans, count, max);
+  }
+  if (count < max) {
+    spans[count].ptr = (const char *)str + start;
+    spans[count].len = n - start;
+  }
+  return count + 1;
+}
+
+#endif
+
+s21_size_t s21_set_stream_threshold(s21_size_t bytes) {
+  s21_size_t previous = s21_stream_threshold;
+  s21_stream_threshold = bytes ? bytes : s21_cache_size();
+  return previous;
+}
+
+const char *s21_memcpy_kernel_name(s21_size_t n) {
+  static const char *const names[][3] = {
+      {"swar-tiny", "swar-loop", "swar-loop"},
+      {"sse2-tiny", "sse2-loop", "sse2-stream"},
+      {"avx2-tiny", "avx2-loop", "avx2-stream"},
+      {"avx512-tiny", "avx512-loop", "avx512-stream"}};
+  static const s21_size_t tiny[] = {16, 32, 64, 128};
+  int level = s21_level();
+  int size_class = 2;
+  if (n <= tiny[level])
+    size_class = 0;
+  else if (n < s21_stream_threshold)
+    size_class = 1;
+  return names[level][size_class];
+}
+
+s21_size_t (*s21_strlen_kernel)(const char *str) = s21_strlen_swar;
+void (*s21_copy_kernel)(char *dest, const char *src,
+                        s21_size_t n) = s21_copy_swar;
+void (*s21_copy_back_kernel)(char *dest, const char *src,
+                             s21_size_t n) = s21_copy_back_swar;
+int (*s21_memcmp_kernel)(const unsigned char *str1, const unsigned char *str2,
+                         s21_size_t n) = s21_memcmp_swar;
+const unsigned char *(*s21_memchr_kernel)(const unsigned char *str,
+                                          unsigned char c,
+                                          s21_size_t n) = s21_memchr_swar;
+const unsigned char *(*s21_memrchr_kernel)(const unsigned char *str,
+                                           unsigned char c,
+                                           s21_size_t n) = s21_memrchr_swar;
+const unsigned char *(*s21_memchr3_kernel)(const unsigned char *str,
+                                           unsigned char c1, unsigned char c2,
+                                           unsigned char c3,
+                                           s21_size_t n) = s21_memchr3_swar;
+const unsigned char *(*s21_pair_kernel)(const unsigned char *str,
+                                        unsigned char c1, unsigned char c2,
+                                        s21_size_t gap,
+                                        s21_size_t n) = s21_pair_swar;
+uint64_t (*s21_teddy_kernel)(const s21_teddy *t, const unsigned char *str,
+                             s21_size_t n, s21_size_t *pos,
+                             unsigned char *buckets) = s21_teddy_scalar;
+void (*s21_set_kernel)(char *dest, unsigned char c,
+                       s21_size_t n) = s21_set_swar;
+void (*s21_fill16_kernel)(char *dest, const unsigned char *pattern,
+                          s21_size_t n) = s21_fill16_swar;
+s21_size_t (*s21_span_kernel)(const unsigned char *str,
+                              const s21_byteset *set,
+                              int accept) = s21_span_scalar;
+s21_size_t (*s21_span_n_kernel)(const unsigned char *str, s21_size_t n,
+                                const s21_byteset *set,
+                                int accept) = s21_span_n_scalar;
+s21_size_t (*s21_split_kernel)(const unsigned char *str, s21_size_t n,
+                               const s21_byteset *set, s21_span_t *spans,
+                               s21_size_t max) = s21_split_scalar;
+s21_size_t s21_stream_threshold = 8ULL << 20;
+
+// DISPATCH
+
+S21_CONSTRUCTOR static void s21_simd_init(void) {
+  s21_stream_threshold = s21_cache_size();
+#if S21_X86
+  int level = s21_level();
+  if (level == 3) {
+    s21_strlen_kernel = s21_strlen_avx512;
+    s21_copy_kernel = s21_copy_avx512;
+    s21_copy_back_kernel = s21_copy_back_avx512;
+    s21_memcmp_kernel = s21_memcmp_avx512;
+    s21_set_kernel = s21_set_avx512;
+    s21_fill16_kernel = s21_fill16_avx512;
+    s21_span_kernel = s21_span_avx512;
+    s21_span_n_kernel = s21_span_n_avx512;
+    s21_split_kernel = s21_split_avx512;
+    s21_memchr_kernel = s21_memchr_avx512;
+    s21_memrchr_kernel = s21_memrchr_avx512;
+    s21_memchr3_kernel = s21_memchr3_avx2;
+    s21_pair_kernel = s21_pair_avx512;
+    s21_teddy_kernel = s21_teddy_avx512;
+  } else if (level == 2) {
+    s21_strlen_kernel = s21_strlen_avx2;
+    s21_copy_kernel = s21_copy_avx2;
+    s21_copy_back_kernel = s21_copy_back_avx2;
+    s21_memcmp_kernel = s21_memcmp_avx2;
+    s21_set_kernel = s21_set_avx2;
+    s21_fill16_kernel = s21_fill16_avx2;
+    s21_span_kernel = s21_span_avx2;
+    s21_span_n_kernel = s21_span_n_avx2;
+    s21_split_kernel = s21_split_avx2;
+    s21_memchr_kernel = s21_memchr_avx2;
+    s21_memrchr_kernel = s21_memrchr_avx2;
+    s21_memchr3_kernel = s21_memchr3_avx2;
+    s21_pair_kernel = s21_pair_avx2;
+    s21_teddy_kernel = s21_teddy_avx2;
+  } else if (level == 1) {
+    s21_strlen_kernel = s21_strlen_sse2;
+    s21_copy_kernel = s21_copy_sse2;
+    s21_copy_back_kernel = s21_copy_back_sse2;
+    s21_memcmp_kernel = s21_memcmp_sse2;
+    s21_set_kernel = s21_set_sse2;
+    s21_fill16_kernel = s21_fill16_sse2;
+    s21_memchr_kernel = s21_memchr_sse2;
+    s21_memrchr_kernel = s21_memrchr_sse2;
+    s21_memchr3_kernel = s21_memchr3_sse2;
+    s21_pair_kernel = s21_pair_sse2;
+  }
+#endif
+}
@@ -0,0 +1,232 @@
+#ifndef S21_SIMD_H_
+#define S21_SIMD_H_
+
+#include <float.h>
+#include <stdint.h>
+
+#include "s21_string.h"
+
+// Internal header shared by the translation units that contain vector
+// kernels and number conversions. Nothing here is part of the public
+// s21_string.h interface.
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define S21_X86 1
+#include <immintrin.h>
+#define S21_TARGET(isa) __attribute__((target(isa)))
+#else
+#define S21_X86 0
+#define S21_TARGET(isa)
+#endif
+
+// Marks kernels that read whole aligned blocks around a C string on
+// purpose, so that AddressSanitizer does not report the bytes outside it.
+#if defined(__has_attribute)
+#if __has_attribute(no_sanitize_address)
+#define S21_NO_SANITIZE __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef S21_NO_SANITIZE
+#define S21_NO_SANITIZE
+#endif
+
+#if defined(__GNUC__)
+#define S21_CTZ(x) __builtin_ctz(x)
+#define S21_CTZLL(x) __builtin_ctzll(x)
+#define S21_CLZ(x) __builtin_clz(x)
+#define S21_CLZLL(x) __builtin_clzll(x)
+#define S21_POPCOUNTLL(x) __builtin_popcountll(x)
+#define S21_CONSTRUCTOR __attribute__((constructor))
+#define S21_INLINE inline __attribute__((always_inline))
+typedef uint64_t __attribute__((may_alias)) s21_word;
+typedef uint64_t __attribute__((may_alias, aligned(1))) s21_u64;
+typedef uint32_t __attribute__((may_alias, aligned(1))) s21_u32;
+typedef uint16_t __attribute__((may_alias, aligned(1))) s21_u16;
+#else
+#define S21_CONSTRUCTOR
+#define S21_INLINE inline
+typedef uint64_t s21_word;
+typedef uint64_t s21_u64;
+typedef uint32_t s21_u32;
+typedef uint16_t s21_u16;
+#endif
+
+// Low 64 bits of a * b; the high 64 bits go to *hi.
+static S21_INLINE uint64_t s21_umul128(uint64_t a, uint64_t b, uint64_t *hi) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 p = (unsigned __int128)a * b;
+  *hi = (uint64_t)(p >> 64);
+  return (uint64_t)p;
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+  uint64_t mid = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+  *hi = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (mid >> 32);
+  return (mid << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+// Bits dist to 63 + dist of hi:lo, for 0 < dist < 64.
+static S21_INLINE uint64_t s21_shr128(uint64_t lo, uint64_t hi, int dist) {
+  return (hi << (64 - dist)) | (lo >> dist);
+}
+
+// 5^0 to 5^25, defined with the float conversions of s21_sprintf.c.
+extern const uint64_t s21_pow5_table[26];
+
+// Unsigned big integer for exact decimal conversions, least significant
+// word first. Enough 32-bit words for the largest long double and for
+// 10^4951.
+#define S21_BIG_WORDS 540
+
+typedef struct {
+  int len;
+  uint32_t w[S21_BIG_WORDS];
+} s21_big;
+
+void s21_big_set(s21_big *a, uint64_t value);
+void s21_big_mul_small(s21_big *a, uint32_t m);
+void s21_big_mul_pow10(s21_big *a, int n);
+void s21_big_shl(s21_big *a, int bits);
+int s21_big_cmp(const s21_big *a, const s21_big *b);
+
+// Long double mantissa bits the conversions handle, in one 64-bit word.
+#if LDBL_MANT_DIG < 64
+#define S21_LDBL_BITS LDBL_MANT_DIG
+#else
+#define S21_LDBL_BITS 64
+#endif
+
+#define S21_LOAD64(p) (*(const s21_u64 *)(const void *)(p))
+#define S21_LOAD32(p) (*(const s21_u32 *)(const void *)(p))
+#define S21_LOAD16(p) (*(const s21_u16 *)(const void *)(p))
+#define S21_STORE64(p, v) (*(s21_u64 *)(void *)(p) = (v))
+#define S21_STORE32(p, v) (*(s21_u32 *)(void *)(p) = (v))
+#define S21_STORE16(p, v) (*(s21_u16 *)(void *)(p) = (v))
+
+#define S21_ONES 0x0101010101010101ULL
+#define S21_HIGHS 0x8080808080808080ULL
+#define S21_HASZERO(w) (((w)-S21_ONES) & ~(w)&S21_HIGHS)
+
+#define S21_CPU_SSE2 0x1
+#define S21_CPU_AVX2 0x2
+#define S21_CPU_AVX512 0x4
+
+// Whether byte c is in an s21_byteset, declared in s21_string.h.
+#define S21_BYTESET_HAS(set, c) \
+  ((int)(((set)->bits[(unsigned char)(c) >> 6] >> ((c)&63)) & 1))
+
+// Fingerprint tables of the Teddy multi-pattern filter. Bit b of lo[j][x]
+// (hi[j][x]) is set when a pattern in bucket b has low (high) nibble x at
+// byte j; len of the 3 rows are in use.
+typedef struct {
+  unsigned char lo[3][16];
+  unsigned char hi[3][16];
+  int len;
+} s21_teddy;
+
+/**
+ * @brief Builds a byte set from the characters of a C string.
+ * @param set pointer to set to initialise
+ * @param chars characters of the set
+ * @param with_nul whether the terminating null character joins the set
+ */
+void s21_byteset_init(s21_byteset *set, const char *chars, int with_nul);
+
+/**
+ * @brief Adds one byte to a byte set.
+ * @param set pointer to set
+ * @param c byte to add
+ */
+void s21_byteset_add(s21_byteset *set, unsigned char c);
+
+/**
+ * @brief Detects vector extensions of the running CPU once and caches the
+ * result. The S21_SIMD environment variable ("swar", "sse2", "avx2",
+ * "avx512") caps the level, which is how every kernel gets tested on one
+ * machine.
+ * @return mask of S21_CPU_* bits
+ */
+int s21_cpu_features(void);
+
+/**
+ * @brief Size of the last level cache, used as the default threshold above
+ * which copies bypass the cache with non-temporal stores.
+ * @return cache size in bytes
+ */
+s21_size_t s21_cache_size(void);
+
+// Kernel entry points, switched by s21_simd_init() before main() runs. They
+// start out pointing at the portable kernels, so calls made by other
+// constructors are still correct.
+
+extern s21_size_t (*s21_strlen_kernel)(const char *str);
+extern void (*s21_copy_kernel)(char *dest, const char *src, s21_size_t n);
+extern void (*s21_copy_back_kernel)(char *dest, const char *src,
+                                    s21_size_t n);
+extern int (*s21_memcmp_kernel)(const unsigned char *str1,
+                                const unsigned char *str2, s21_size_t n);
+extern const unsigned char *(*s21_memchr_kernel)(const unsigned char *str,
+                                                 unsigned char c,
+                                                 s21_size_t n);
+extern const unsigned char *(*s21_memrchr_kernel)(const unsigned char *str,
+                                                  unsigned char c,
+                                                  s21_size_t n);
+extern const unsigned char *(*s21_memchr3_kernel)(const unsigned char *str,
+                                                  unsigned char c1,
+                                                  unsigned char c2,
+                                                  unsigned char c3,
+                                                  s21_size_t n);
+// First position i < n with str[i] == c1 and str[i + gap] == c2, the
+// candidate filter of substring search. Reads [str, str + n + gap).
+extern const unsigned char *(*s21_pair_kernel)(const unsigned char *str,
+                                               unsigned char c1,
+                                               unsigned char c2,
+                                               s21_size_t gap, s21_size_t n);
+// Finds the first block of 64 positions from *pos on, below n, where
+// str[i..i + t->len) matches the fingerprint of some bucket. Moves *pos to
+// the block, stores the bucket bits of position *pos + k in buckets[k] and
+// returns the mask of candidate positions in the block, 0 if there is none;
+// positions below the *pos it was called with are never in the mask.
+// Reads [str, str + n + len - 1). The scalar kernel below the AVX2 level is
+// correct but slow.
+extern uint64_t (*s21_teddy_kernel)(const s21_teddy *t,
+                                    const unsigned char *str, s21_size_t n,
+                                    s21_size_t *pos, unsigned char *buckets);
+extern void (*s21_set_kernel)(char *dest, unsigned char c, s21_size_t n);
+extern void (*s21_fill16_kernel)(char *dest, const unsigned char *pattern,
+                                 s21_size_t n);
+
+// Length of the initial segment of a C string whose bytes are in the set
+// (accept = 1) or are not in it (accept = 0). The terminating null must
+// stop the scan, so it must be in the set exactly when accept is 0.
+extern s21_size_t (*s21_span_kernel)(const unsigned char *str,
+                                     const s21_byteset *set, int accept);
+
+// The same within the first n bytes of a buffer, where the null character
+// is an ordinary byte. Returns n when no byte stops the span.
+extern s21_size_t (*s21_span_n_kernel)(const unsigned char *str, s21_size_t n,
+                                       const s21_byteset *set, int accept);
+
+// Splits [str, str + n) at every byte of the set, stores the first max
+// fields in spans and returns the number of fields, delimiters + 1.
+extern s21_size_t (*s21_split_kernel)(const unsigned char *str, s21_size_t n,
+                                      const s21_byteset *set,
+                                      s21_span_t *spans, s21_size_t max);
+
+// First occurrence of needle[0..m) in hay[0..n), defined in s21_string.c.
+// Null characters are ordinary bytes.
+const unsigned char *s21_find(const unsigned char *hay, s21_size_t n,
+                              const unsigned char *needle, s21_size_t m);
+
+// Next aligned block of arena and the bytes free after it in the current
+// chunk, without taking them; defined in s21_alloc.c. A later
+// s21_arena_alloc of at most *room bytes returns the same block.
+char *s21_arena_space(s21_arena *arena, s21_size_t *room);
+
+// Copies and fills at or above this size use non-temporal stores.
+extern s21_size_t s21_stream_threshold;
+
+#endif
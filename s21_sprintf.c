@@ -1,543 +1,1668 @@
+#include <errno.h>
+#include <float.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "s21_simd.h"
 #include "s21_string.h"
 
-// SPRINTF
+// INTEGER CONVERSION
 
-int s21_sprintf(char *str, const char *format, ...) {
-  s21_size_t i = 0, count = 0;
-  char *str_val = s21_NULL;
-  va_list ap;
-  va_start(ap, format);
-  while (format[i] != '\0') {
-    if (format[i] != '%') {
-      str[count++] = format[i++];
-      continue;
+// "00" to "99", so two decimal digits are stored per division.
+static const char s21_digit_pairs[] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334"
+    "3536373839404142434445464748495051525354555657585960616263646566676869"
+    "707172737475767778798081828384858687888990919293949596979899";
+
+static const unsigned long long s21_pow10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+    1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL};
+
+// Number of decimal digits of value, 1 for 0. The bit length gives the
+// count up to one, which the power of ten table settles.
+static S21_INLINE int s21_dec_len(unsigned long long value) {
+  int bits = 64 - S21_CLZLL(value | 1);
+  int len = (bits * 1233) >> 12;
+  return len + ((value | 1) >= s21_pow10[len]);
+}
+
+// Stores the decimal digits of value so that they end at end. Each 64-bit
+// division yields four digits, which 32-bit arithmetic splits into pairs.
+static S21_INLINE void s21_put_dec(char *end, unsigned long long value) {
+  while (value >= 10000) {
+    unsigned quad = (unsigned)(value % 10000);
+    unsigned hi = quad / 100, lo = quad % 100;
+    value /= 10000;
+    end -= 4;
+    end[0] = s21_digit_pairs[2 * hi];
+    end[1] = s21_digit_pairs[2 * hi + 1];
+    end[2] = s21_digit_pairs[2 * lo];
+    end[3] = s21_digit_pairs[2 * lo + 1];
+  }
+  if (value >= 100) {
+    unsigned pair = (unsigned)(value % 100);
+    value /= 100;
+    end -= 2;
+    end[0] = s21_digit_pairs[2 * pair];
+    end[1] = s21_digit_pairs[2 * pair + 1];
+  }
+  if (value >= 10) {
+    end[-1] = s21_digit_pairs[2 * value + 1];
+    end[-2] = s21_digit_pairs[2 * value];
+  } else {
+    end[-1] = (char)('0' + value);
+  }
+}
+
+// Number of hexadecimal digits of value, 1 for 0.
+static S21_INLINE int s21_hex_len(unsigned long long value) {
+  return (67 - S21_CLZLL(value | 1)) >> 2;
+}
+
+static S21_INLINE void s21_put_hex(char *end, unsigned long long value,
+                                   int upper) {
+  const char *alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  do {
+    *--end = alphabet[value & 15];
+    value >>= 4;
+  } while (value);
+}
+
+s21_size_t s21_u64toa(unsigned long long value, char *buf) {
+  int len = s21_dec_len(value);
+  s21_put_dec(buf + len, value);
+  buf[len] = '\0';
+  return len;
+}
+
+s21_size_t s21_i64toa(long long value, char *buf) {
+  unsigned long long mag = (unsigned long long)value;
+  s21_size_t sign = 0;
+  if (value < 0) {
+    buf[sign++] = '-';
+    mag = 0 - mag;
+  }
+  return sign + s21_u64toa(mag, buf + sign);
+}
+
+s21_size_t s21_u64toa_hex(unsigned long long value, char *buf, int upper) {
+  int len = s21_hex_len(value);
+  s21_put_hex(buf + len, value, upper);
+  buf[len] = '\0';
+  return len;
+}
+
+// FLOAT CONVERSION
+
+// Shortest round-trip digits of a double, after Ryu (Ulf Adams, PLDI 2018).
+// The 128-bit multipliers for 5^i and 2^k / 5^i are rebuilt from one entry
+// per 26 powers and s21_pow5_table; the offsets hold the 2-bit corrections
+// that make the result equal to the exact floor.
+
+#define S21_DOUBLE_BIAS 1023
+#define S21_DOUBLE_MANT_BITS 52
+#define S21_POW5_BITS 125
+#define S21_POW5_STEP 26
+
+static const uint64_t s21_pow5_split[13][2] = {
+    {0x0000000000000000ULL, 0x1000000000000000ULL},
+    {0x0000000000000000ULL, 0x14adf4b7320334b9ULL},
+    {0x0e549208b31adb10ULL, 0x1aba4714957d300dULL},
+    {0x6dc6ad264d8f0866ULL, 0x1145b7e285bf98f5ULL},
+    {0xeb1dbd923d8596caULL, 0x1652efdc6018a1fcULL},
+    {0xb4c1b80b22ae923cULL, 0x1cda62055b2d9d83ULL},
+    {0x5bb28b4e8f7e4c30ULL, 0x12a5568b9f52f416ULL},
+    {0xf08aed437682d4fbULL, 0x1819651531f9e78fULL},
+    {0xb4ee134ad99bf150ULL, 0x1f25c186a6f04c28ULL},
+    {0x16499ecb70c25f03ULL, 0x1420eb449c8842e6ULL},
+    {0x85a56ead360865b0ULL, 0x1a03fde214caf085ULL},
+    {0x093db1d57999890bULL, 0x10cfeb353a97dad8ULL},
+    {0xcf38bb735e3f36acULL, 0x15baaf44fa52673eULL}};
+
+static const uint64_t s21_pow5_inv_split[13][2] = {
+    {0x0000000000000001ULL, 0x2000000000000000ULL},
+    {0x52a6c95fc0655034ULL, 0x18c240c4aecb13bbULL},
+    {0x7ca8d50071dfc806ULL, 0x1327fc58da0f6ff5ULL},
+    {0x6520247d3556476eULL, 0x1da48ce468e7c702ULL},
+    {0x6139cdd76802e6e9ULL, 0x16ef5b40c2fc7779ULL},
+    {0xf951a7ff43de8c79ULL, 0x11bebdf578b2f391ULL},
+    {0x7be8bee8d6e957e8ULL, 0x1b758d848fac54b0ULL},
+    {0x8bd3f9e999a423eaULL, 0x153eda614071a3b7ULL},
+    {0x0848f973cb3ee3ceULL, 0x10701bd527b4978cULL},
+    {0x153285ebb9efbfa2ULL, 0x196fbb9bb44db44dULL},
+    {0xadeee7f86c07b696ULL, 0x13ae3591f5b4d936ULL},
+    {0x4d686a4eaf182222ULL, 0x1e74404f3daada91ULL},
+    {0x98c0a106e09ebd9fULL, 0x17900ea4fda7c257ULL}};
+
+static const uint32_t s21_pow5_offsets[21] = {
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x40000000, 0x59695995,
+    0x55545555, 0x56555515, 0x41150504, 0x40555410, 0x44555145, 0x44504540,
+    0x45555550, 0x40004000, 0x96440440, 0x55565565, 0x54454045, 0x40154151,
+    0x55559155, 0x51405555, 0x00000105};
+
+static const uint32_t s21_pow5_inv_offsets[19] = {
+    0x54544554, 0x04055545, 0x10041000, 0x00400414, 0x40010000, 0x41155555,
+    0x00000454, 0x00010044, 0x40000000, 0x44000041, 0x50454450, 0x55550054,
+    0x51655554, 0x40004000, 0x01000001, 0x00010500, 0x51515411, 0x05555554,
+    0x50411500};
+
+const uint64_t s21_pow5_table[26] = {
+    1ULL, 5ULL, 25ULL, 125ULL, 625ULL, 3125ULL, 15625ULL, 78125ULL, 390625ULL,
+    1953125ULL, 9765625ULL, 48828125ULL, 244140625ULL, 1220703125ULL,
+    6103515625ULL, 30517578125ULL, 152587890625ULL, 762939453125ULL,
+    3814697265625ULL, 19073486328125ULL, 95367431640625ULL, 476837158203125ULL,
+    2384185791015625ULL, 11920928955078125ULL, 59604644775390625ULL,
+    298023223876953125ULL};
+
+// ceil(log2(5^e)) for e > 0, and 1 for 0.
+static S21_INLINE int s21_pow5bits(int e) {
+  return (int)(((unsigned)e * 1217359u) >> 19) + 1;
+}
+
+static S21_INLINE int s21_log10_pow2(int e) {
+  return (int)(((unsigned)e * 78913u) >> 18);
+}
+
+static S21_INLINE int s21_log10_pow5(int e) {
+  return (int)(((unsigned)e * 732923u) >> 20);
+}
+
+// floor(5^i / 2^(pow5bits(i) - 125)).
+static void s21_pow5(int i, uint64_t *res) {
+  int base = i / S21_POW5_STEP, offset = i - base * S21_POW5_STEP;
+  const uint64_t *mul = s21_pow5_split[base];
+  if (offset == 0) {
+    res[0] = mul[0];
+    res[1] = mul[1];
+  } else {
+    uint64_t m = s21_pow5_table[offset], high0, high1;
+    uint64_t low1 = s21_umul128(m, mul[1], &high1);
+    uint64_t low0 = s21_umul128(m, mul[0], &high0);
+    uint64_t sum = high0 + low1;
+    int delta = s21_pow5bits(i) - s21_pow5bits(base * S21_POW5_STEP);
+    if (sum < high0) high1++;
+    res[0] = s21_shr128(low0, sum, delta) +
+             ((s21_pow5_offsets[i / 16] >> ((i % 16) << 1)) & 3);
+    res[1] = s21_shr128(sum, high1, delta);
+  }
+}
+
+// floor(2^(pow5bits(i) - 1 + 125) / 5^i) + 1.
+static void s21_inv_pow5(int i, uint64_t *res) {
+  int base = (i + S21_POW5_STEP - 1) / S21_POW5_STEP;
+  int offset = base * S21_POW5_STEP - i;
+  const uint64_t *mul = s21_pow5_inv_split[base];
+  if (offset == 0) {
+    res[0] = mul[0];
+    res[1] = mul[1];
+  } else {
+    uint64_t m = s21_pow5_table[offset], high0, high1;
+    uint64_t low1 = s21_umul128(m, mul[1], &high1);
+    uint64_t low0 = s21_umul128(m, mul[0] - 1, &high0);
+    uint64_t sum = high0 + low1;
+    int delta = s21_pow5bits(base * S21_POW5_STEP) - s21_pow5bits(i);
+    if (sum < high0) high1++;
+    res[0] = s21_shr128(low0, sum, delta) + 1 +
+             ((s21_pow5_inv_offsets[i / 16] >> ((i % 16) << 1)) & 3);
+    res[1] = s21_shr128(sum, high1, delta);
+  }
+}
+
+// (m * mul) >> j for a multiplier of 125 bits and 64 < j < 128.
+static S21_INLINE uint64_t s21_mul_shift(uint64_t m, const uint64_t *mul,
+                                         int j) {
+  uint64_t high0, high1;
+  uint64_t low1 = s21_umul128(m, mul[1], &high1);
+  s21_umul128(m, mul[0], &high0);
+  uint64_t sum = high0 + low1;
+  if (sum < high0) high1++;
+  return s21_shr128(sum, high1, j - 64);
+}
+
+static S21_INLINE int s21_pow5_factor(uint64_t value) {
+  int count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    count++;
+  }
+  return count;
+}
+
+// Shortest decimal d * 10^e10 that reads back as the finite, nonzero double
+// with the given IEEE fields; returns d.
+static uint64_t s21_shortest(uint64_t ieee_mant, int ieee_exp, int *exp10) {
+  int e2;
+  uint64_t m2;
+  if (ieee_exp == 0) {
+    e2 = 1 - S21_DOUBLE_BIAS - S21_DOUBLE_MANT_BITS - 2;
+    m2 = ieee_mant;
+  } else {
+    e2 = ieee_exp - S21_DOUBLE_BIAS - S21_DOUBLE_MANT_BITS - 2;
+    m2 = (1ULL << S21_DOUBLE_MANT_BITS) | ieee_mant;
+  }
+  // Integers below 2^53 need no multiplication, only their trailing zeros
+  // taken off.
+  int int_shift = S21_DOUBLE_BIAS + S21_DOUBLE_MANT_BITS - ieee_exp;
+  if (ieee_exp != 0 && int_shift >= 0 && int_shift <= 52 &&
+      (m2 & ((1ULL << int_shift) - 1)) == 0) {
+    uint64_t value = m2 >> int_shift;
+    *exp10 = 0;
+    while (value % 10 == 0) {
+      value /= 10;
+      (*exp10)++;
     }
-    Format form = {0, 0, 0, 0, 0, 0, -1, '\0', '\0', 0, 0, '\0', 0};
-    i++;
-    if (format[i] == '\0') return -1;
-    if (format[i] == '%') {
-      str[count++] = format[i++];
-      continue;
+    return value;
+  }
+  int accept_bounds = (m2 & 1) == 0;
+  // The value is mv / 4 * 2^e2; the interval of decimals that read back as
+  // it has bounds (mv + 2) / 4 and (mv - 1 - mm_shift) / 4.
+  uint64_t mv = 4 * m2;
+  int mm_shift = ieee_mant != 0 || ieee_exp <= 1;
+  uint64_t mul[2], vr, vp, vm;
+  int e10, vm_trailing_zeros = 0, vr_trailing_zeros = 0;
+  if (e2 >= 0) {
+    int q = s21_log10_pow2(e2) - (e2 > 3);
+    int i = -e2 + q + S21_POW5_BITS + s21_pow5bits(q) - 1;
+    e10 = q;
+    s21_inv_pow5(q, mul);
+    vr = s21_mul_shift(4 * m2, mul, i);
+    vp = s21_mul_shift(4 * m2 + 2, mul, i);
+    vm = s21_mul_shift(4 * m2 - 1 - mm_shift, mul, i);
+    if (q <= 21) {
+      if (mv % 5 == 0)
+        vr_trailing_zeros = s21_pow5_factor(mv) >= q;
+      else if (accept_bounds)
+        vm_trailing_zeros = s21_pow5_factor(mv - 1 - mm_shift) >= q;
+      else
+        vp -= s21_pow5_factor(mv + 2) >= q;
+    }
+  } else {
+    int q = s21_log10_pow5(-e2) - (-e2 > 1);
+    int i = -e2 - q;
+    int j = q - (s21_pow5bits(i) - S21_POW5_BITS);
+    e10 = q + e2;
+    s21_pow5(i, mul);
+    vr = s21_mul_shift(4 * m2, mul, j);
+    vp = s21_mul_shift(4 * m2 + 2, mul, j);
+    vm = s21_mul_shift(4 * m2 - 1 - mm_shift, mul, j);
+    if (q <= 1) {
+      vr_trailing_zeros = 1;
+      if (accept_bounds)
+        vm_trailing_zeros = mm_shift == 1;
+      else
+        vp--;
+    } else if (q < 63) {
+      vr_trailing_zeros = (mv & ((1ULL << q) - 1)) == 0;
     }
-    while (format[i] && format[i] == ' ' && format[i + 1] == ' ') i++;
-    s21_parse_flags(format, &i, &form);
-    s21_parse_width(&ap, format, &i, &form);
-    s21_parse_accuracy(&ap, format, &i, &form);
-    s21_parse_length(format, &i, &form);
-    form.spec = format[i];
-    str_val = s21_switch_spec(&ap, count, &form);
-    s21_process_flags(str_val, &form);
-    s21_strcpy(&str[count], str_val);
-    count += s21_strlen(str_val);
-    if (str_val) free(str_val);
-    str_val = s21_NULL;
-    i++;
   }
-  va_end(ap);
-  str[count] = '\0';
-  return count;
+  int removed = 0, last_digit = 0;
+  uint64_t output;
+  if (vm_trailing_zeros || vr_trailing_zeros) {
+    // Rare: the bounds or the value itself are exact decimals.
+    while (vp / 10 > vm / 10) {
+      vm_trailing_zeros &= vm % 10 == 0;
+      vr_trailing_zeros &= last_digit == 0;
+      last_digit = (int)(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    if (vm_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_trailing_zeros &= last_digit == 0;
+        last_digit = (int)(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        removed++;
+      }
+    }
+    // An exact ...50 rounds to even.
+    if (vr_trailing_zeros && last_digit == 5 && vr % 2 == 0) last_digit = 4;
+    output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                   last_digit >= 5);
+  } else {
+    int round_up = 0;
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+  *exp10 = e10 + removed;
+  return output;
 }
 
-// SPRINTF FUNCTIONS
+// Exact digits. The value is r / s with both held as big integers; scaling
+// one of them by a power of ten brings r / s into [1, 10), and every digit
+// is then the quotient of r / s before r is multiplied by 10 again. This is
+// what %f, %e and %g use, since they must round the exact binary value.
 
-void s21_parse_flags(const char *format, s21_size_t *i, Format *form) {
-  while (s21_strchr("# +-0", format[*i]) != s21_NULL && format[*i]) {
-    if (format[*i] == '#' && form->flag_r == 0)
-      form->flag_r = 1;
-    else if (format[*i] == ' ' && form->flag_s == 0)
-      form->flag_s = 1;
-    else if (format[*i] == '+' && form->flag_p == 0)
-      form->flag_p = 1;
-    else if (format[*i] == '-' && form->flag_m == 0)
-      form->flag_m = 1;
-    else if (format[*i] == '0' && form->flag_z == 0)
-      form->flag_z = 1;
-    (*i)++;
+// Digits kept per conversion, enough for every exact expansion: a double
+// has at most 767 significant digits and a long double with a 64-bit
+// mantissa at most 11514 (2^-16382 times an odd mantissa has 16445 digits
+// after the point, 4931 of them leading zeros). Positions past the exact
+// expansion are zeros, so no precision needs more.
+#define S21_DIGITS_MAX 12000
+
+// Decimal digits, without leading zeros, and the power of ten of the first.
+// Positions past len are zeros.
+typedef struct {
+  int len;
+  int exp;
+  char digits[S21_DIGITS_MAX];
+} s21_decimal;
+
+void s21_big_set(s21_big *a, uint64_t value) {
+  a->w[0] = (uint32_t)value;
+  a->w[1] = (uint32_t)(value >> 32);
+  a->len = a->w[1] ? 2 : a->w[0] ? 1 : 0;
+}
+
+static void s21_big_copy(s21_big *a, const s21_big *b) {
+  a->len = b->len;
+  for (int k = 0; k < b->len; k++) a->w[k] = b->w[k];
+}
+
+void s21_big_mul_small(s21_big *a, uint32_t m) {
+  uint64_t carry = 0;
+  for (int k = 0; k < a->len; k++) {
+    carry += (uint64_t)a->w[k] * m;
+    a->w[k] = (uint32_t)carry;
+    carry >>= 32;
   }
+  if (carry) a->w[a->len++] = (uint32_t)carry;
 }
 
-void s21_parse_width(va_list *ap, const char *format, s21_size_t *i,
-                     Format *form) {
-  if (s21_strchr("-0123456789", format[*i]) != s21_NULL) {
-    if (format[*i] == '-') (*i)++;
-    while (s21_strchr("-0123456789", format[*i]) != s21_NULL) {
-      form->width = form->width * 10 + ((int)format[*i] - '0');
-      (*i)++;
-    }
-  } else if (format[*i] == '*') {
-    form->width = va_arg(*ap, int);
-    if (form->width < 0) {
-      form->width = -form->width;
-      form->flag_m = 1;
+void s21_big_mul_pow10(s21_big *a, int n) {
+  for (; n >= 9; n -= 9) s21_big_mul_small(a, 1000000000u);
+  if (n > 0) s21_big_mul_small(a, (uint32_t)s21_pow10[n]);
+}
+
+void s21_big_shl(s21_big *a, int bits) {
+  int words = bits / 32, shift = bits % 32;
+  if (a->len > 0) {
+    a->w[a->len] = 0;
+    for (int k = a->len; k >= 0; k--) {
+      uint32_t hi = a->w[k] << shift;
+      if (shift && k > 0) hi |= a->w[k - 1] >> (32 - shift);
+      a->w[k + words] = hi;
     }
-    (*i)++;
+    for (int k = 0; k < words; k++) a->w[k] = 0;
+    a->len += words + 1;
+    while (a->len > 0 && a->w[a->len - 1] == 0) a->len--;
   }
 }
 
-void s21_parse_accuracy(va_list *ap, const char *format, s21_size_t *i,
-                        Format *form) {
-  if (format[*i] == '.') {
-    (*i)++;
-    if (s21_strchr("0123456789", format[*i]) != s21_NULL) {
-      form->accuracy = 0;
-      while (s21_strchr("0123456789", format[*i]) != s21_NULL) {
-        form->accuracy = form->accuracy * 10 + ((int)format[*i] - '0');
-        (*i)++;
+int s21_big_cmp(const s21_big *a, const s21_big *b) {
+  int res = (a->len > b->len) - (a->len < b->len);
+  for (int k = a->len - 1; res == 0 && k >= 0; k--)
+    res = (a->w[k] > b->w[k]) - (a->w[k] < b->w[k]);
+  return res;
+}
+
+// a -= b, for a >= b.
+static void s21_big_sub(s21_big *a, const s21_big *b) {
+  int64_t borrow = 0;
+  for (int k = 0; k < a->len; k++) {
+    borrow += (int64_t)a->w[k] - (k < b->len ? b->w[k] : 0);
+    a->w[k] = (uint32_t)borrow;
+    borrow >>= 32;
+  }
+  while (a->len > 0 && a->w[a->len - 1] == 0) a->len--;
+}
+
+// a += b.
+static void s21_big_add(s21_big *a, const s21_big *b) {
+  uint64_t carry = 0;
+  int len = a->len > b->len ? a->len : b->len;
+  for (int k = 0; k < len; k++) {
+    carry += (uint64_t)(k < a->len ? a->w[k] : 0) + (k < b->len ? b->w[k] : 0);
+    a->w[k] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  a->len = len;
+  if (carry) a->w[a->len++] = (uint32_t)carry;
+}
+
+// Whether a + b reaches c: a + b >= c with inclusive set, a + b > c
+// otherwise.
+static int s21_big_sum_reaches(const s21_big *a, const s21_big *b,
+                               const s21_big *c, int inclusive) {
+  s21_big t;
+  s21_big_copy(&t, a);
+  s21_big_add(&t, b);
+  int res = s21_big_cmp(&t, c);
+  return inclusive ? res >= 0 : res > 0;
+}
+
+// Rounds the value mant * 2^exp2 to count significant digits, or with fixed
+// set to the digits down to 10^-count, halfway cases to even.
+static void s21_exact(s21_decimal *dec, uint64_t mant, int exp2, int count,
+                      int fixed) {
+  s21_big r, s;
+  dec->len = 0;
+  dec->exp = fixed ? -count : 0;
+  if (mant == 0) return;
+  s21_big_set(&r, mant);
+  s21_big_set(&s, 1);
+  if (exp2 > 0)
+    s21_big_shl(&r, exp2);
+  else
+    s21_big_shl(&s, -exp2);
+  // The value is in [2^(bits - 1), 2^bits), so bits * log10(2) is within
+  // one of the exponent of its first digit; the tests below settle it.
+  int bits = 64 - S21_CLZLL(mant) + exp2;
+  int e = (int)(((int64_t)bits * 646456993) >> 31);
+  if (e >= 0)
+    s21_big_mul_pow10(&s, e);
+  else
+    s21_big_mul_pow10(&r, -e);
+  s21_big t;
+  s21_big_copy(&t, &s);
+  s21_big_mul_small(&t, 10);
+  if (s21_big_cmp(&r, &t) >= 0) {
+    s21_big_copy(&s, &t);
+    e++;
+  }
+  while (s21_big_cmp(&r, &s) < 0) {
+    s21_big_mul_small(&r, 10);
+    e--;
+  }
+  int n = fixed ? e + 1 + count : count;
+  dec->exp = e;
+  if (n <= 0) {
+    // Nothing but the rounding of the first digit into position -count.
+    s21_big_mul_small(&s, 5);
+    if (n == 0 && s21_big_cmp(&r, &s) > 0) {
+      dec->digits[dec->len++] = '1';
+      dec->exp = e + 1;
+    }
+    return;
+  }
+  int limit = n < S21_DIGITS_MAX ? n : S21_DIGITS_MAX;
+  while (dec->len < limit && r.len > 0) {
+    if (dec->len > 0) s21_big_mul_small(&r, 10);
+    int digit = 0;
+    while (s21_big_cmp(&r, &s) >= 0) {
+      s21_big_sub(&r, &s);
+      digit++;
+    }
+    dec->digits[dec->len++] = (char)('0' + digit);
+  }
+  if (r.len > 0) {
+    s21_big_shl(&r, 1);
+    int half = s21_big_cmp(&r, &s);
+    if (half > 0 || (half == 0 && (dec->digits[dec->len - 1] - '0') % 2)) {
+      int k = dec->len - 1;
+      while (k >= 0 && dec->digits[k] == '9') dec->digits[k--] = '0';
+      if (k >= 0) {
+        dec->digits[k]++;
+      } else {
+        dec->digits[0] = '1';
+        dec->exp++;
       }
-    } else if (format[*i] == '*') {
-      form->accuracy = va_arg(*ap, int);
-      if (form->accuracy < 0) form->accuracy = 6;
-      (*i)++;
+    }
+  }
+}
+
+// Shortest digits that read back as the long double mant * 2^exp2, where
+// mant holds the 64 leading bits. Ryu covers doubles only, so these come
+// from the free-format algorithm of Steele and White on big integers:
+// r / s is the remaining value and m_minus / s and m_plus / s the distances
+// to the midpoints with the neighbouring long doubles. Digits stop once
+// the remainder is within either distance; even mantissas round to
+// themselves on a tie, so their midpoints count as inside.
+static void s21_shortest_exact(s21_decimal *dec, uint64_t mant, int exp2) {
+  const int emin = LDBL_MIN_EXP - LDBL_MANT_DIG;
+  s21_big r, s, m_minus, m_plus, t;
+  mant >>= 64 - S21_LDBL_BITS;
+  exp2 += 64 - S21_LDBL_BITS;
+  if (exp2 < emin) {
+    // A subnormal carries fewer bits; its last one is worth 2^emin.
+    mant >>= emin - exp2;
+    exp2 = emin;
+  }
+  int inclusive = (mant & 1) == 0;
+  int closer = mant == 1ULL << (S21_LDBL_BITS - 1) && exp2 > emin;
+  s21_big_set(&r, mant);
+  s21_big_set(&s, 1);
+  s21_big_set(&m_minus, 1);
+  if (exp2 > 0) {
+    s21_big_shl(&r, exp2);
+    s21_big_shl(&m_minus, exp2);
+  } else {
+    s21_big_shl(&s, -exp2);
+  }
+  s21_big_shl(&r, 1 + closer);
+  s21_big_shl(&s, 1 + closer);
+  s21_big_copy(&m_plus, &m_minus);
+  s21_big_shl(&m_plus, closer);
+  // Scaled by 10^-k, so that (r + m_plus) / s lies in [0.1, 1).
+  int bits = 64 - S21_CLZLL(mant) + exp2;
+  int k = (int)(((int64_t)bits * 646456993) >> 31) + 1;
+  if (k >= 0) {
+    s21_big_mul_pow10(&s, k);
+  } else {
+    s21_big_mul_pow10(&r, -k);
+    s21_big_mul_pow10(&m_minus, -k);
+    s21_big_mul_pow10(&m_plus, -k);
+  }
+  while (s21_big_sum_reaches(&r, &m_plus, &s, inclusive)) {
+    s21_big_mul_small(&s, 10);
+    k++;
+  }
+  for (;;) {
+    s21_big_copy(&t, &m_plus);
+    s21_big_mul_small(&t, 10);
+    s21_big_mul_small(&r, 10);
+    if (s21_big_sum_reaches(&r, &t, &s, inclusive)) break;
+    s21_big_copy(&m_plus, &t);
+    s21_big_mul_small(&m_minus, 10);
+    k--;
+  }
+  // r is already ten times the remainder; m_minus and m_plus follow.
+  dec->len = 0;
+  dec->exp = k - 1;
+  for (int first = 1;; first = 0) {
+    if (!first) s21_big_mul_small(&r, 10);
+    s21_big_mul_small(&m_minus, 10);
+    s21_big_mul_small(&m_plus, 10);
+    int digit = 0;
+    while (s21_big_cmp(&r, &s) >= 0) {
+      s21_big_sub(&r, &s);
+      digit++;
+    }
+    int low = s21_big_cmp(&r, &m_minus);
+    int stop_low = inclusive ? low <= 0 : low < 0;
+    int stop_high = s21_big_sum_reaches(&r, &m_plus, &s, inclusive);
+    if (stop_low && stop_high) {
+      // Both ends are near: take the closer digit, the even one on a tie.
+      s21_big_copy(&t, &r);
+      s21_big_shl(&t, 1);
+      int half = s21_big_cmp(&t, &s);
+      if (half > 0 || (half == 0 && digit % 2)) digit++;
+    } else if (stop_high) {
+      digit++;
+    }
+    dec->digits[dec->len++] = (char)('0' + digit);
+    if (stop_low || stop_high) break;
+  }
+}
+
+// Rounds an integer part plus a fraction, nonzero when frac is set, divided
+// by 10^j, halfway cases to even.
+static uint64_t s21_div_round(uint64_t value, int frac, int j) {
+  uint64_t q = value / s21_pow10[j], rem = value - q * s21_pow10[j];
+  uint64_t half = s21_pow10[j] / 2;
+  return q + (rem > half || (rem == half && (frac || (q & 1))));
+}
+
+// Rounds mant * 2^exp2 * 10^k to an integer, halfway cases to even, for
+// -19 <= k <= 25. The product with 5^k has at most 123 bits, so the
+// remainder is exact; a negative k divides the integer part instead.
+// Returns 0 when the result or the integer part does not fit in 64 bits.
+static int s21_scaled_round(uint64_t mant, int exp2, int k, uint64_t *res) {
+  if (k < 0) {
+    if (exp2 >= 0 && exp2 < S21_CLZLL(mant)) {
+      *res = s21_div_round(mant << exp2, 0, -k);
+    } else if (exp2 < 0 && exp2 > -64) {
+      uint64_t frac = mant & ((1ULL << -exp2) - 1);
+      *res = s21_div_round(mant >> -exp2, frac != 0, -k);
     } else {
-      form->accuracy = 0;
+      return 0;
     }
+    return 1;
   }
+  uint64_t hi, lo = s21_umul128(mant, s21_pow5_table[k], &hi);
+  int shift = -(exp2 + k), up = 0;
+  uint64_t q;
+  if (shift <= 0) {
+    if (hi != 0 || shift < -63 || (shift < 0 && lo >> (64 + shift) != 0))
+      return 0;
+    *res = lo << -shift;
+    return 1;
+  }
+  if (shift >= 128) return 0;
+  if (shift < 64) {
+    uint64_t rem = lo & ((1ULL << shift) - 1), half = 1ULL << (shift - 1);
+    if (hi >> shift != 0) return 0;
+    q = s21_shr128(lo, hi, shift);
+    up = rem > half || (rem == half && (q & 1));
+  } else {
+    uint64_t rem = shift == 64 ? 0 : hi & ((1ULL << (shift - 64)) - 1);
+    uint64_t half = shift == 64 ? 0 : 1ULL << (shift - 65);
+    q = shift == 64 ? hi : hi >> (shift - 64);
+    if (shift == 64) {
+      up = lo > 1ULL << 63 || (lo == 1ULL << 63 && (q & 1));
+    } else {
+      up = rem > half || (rem == half && (lo > 0 || (q & 1)));
+    }
+  }
+  if (up && ++q == 0) return 0;
+  *res = q;
+  return 1;
 }
 
-void s21_parse_length(const char *format, s21_size_t *i, Format *form) {
-  if (s21_strchr("hlL", format[*i]) != s21_NULL) {
-    form->length = format[*i];
-    (*i)++;
-    if (s21_strchr("hlL", format[*i]) != s21_NULL) {
-      form->length2 = format[*i];
-      (*i)++;
+// Fast form of s21_exact for results of at most 17 digits that the 64-bit
+// scaled value holds. Returns 0 to leave the value to s21_exact.
+static int s21_scaled_digits(s21_decimal *dec, uint64_t mant, int exp2,
+                             int count, int fixed) {
+  uint64_t n;
+  int k = count;
+  if (!fixed) {
+    // The first digit has the exponent e or e - 1; rounding for e - 1 shows
+    // which one, since for e the result exceeds 10^count.
+    int bits = 64 - S21_CLZLL(mant) + exp2;
+    int e = (int)(((int64_t)bits * 646456993) >> 31);
+    if (count > 17) return 0;
+    k = count - e;
+    if (k < -19 || k > 25 || !s21_scaled_round(mant, exp2, k, &n)) return 0;
+    if (n > s21_pow10[count]) k--;
+  }
+  if (k < -19 || k > 25 || !s21_scaled_round(mant, exp2, k, &n)) return 0;
+  dec->len = 0;
+  dec->exp = -count;
+  if (n != 0) {
+    dec->len = s21_dec_len(n);
+    dec->exp = dec->len - 1 - k;
+    s21_put_dec(dec->digits + dec->len, n);
+  }
+  return 1;
+}
+
+// SPRINTF
+
+// Destination of the formatter. Bytes past size - 1 are counted but not
+// stored, which is what gives s21_snprintf its return value. With a sink,
+// buf is the sink buffer, the size is one more since no null character is
+// stored, and start and flushed track what this call wrote.
+typedef struct {
+  char *buf;
+  s21_size_t size;
+  s21_size_t count;
+  s21_sink *sink;
+  s21_size_t start;
+  s21_size_t flushed;
+} s21_out;
+
+static void s21_sink_put(s21_sink *sink, const char *src, char c,
+                         s21_size_t n);
+
+static void s21_out_spill(s21_out *out, const char *src, char c,
+                          s21_size_t n) {
+  if (out->sink != s21_NULL) {
+    s21_sink *sink = out->sink;
+    sink->len = out->count;
+    s21_sink_put(sink, src, c, n);
+    out->flushed += out->count + n - sink->len;
+    out->buf = sink->buf;
+    out->size = sink->size + 1;
+    out->count = sink->len;
+    return;
+  }
+  if (out->count + 1 < out->size) {
+    s21_size_t room = out->size - 1 - out->count;
+    if (src != s21_NULL)
+      s21_memcpy(out->buf + out->count, src, n < room ? n : room);
+    else
+      s21_memset(out->buf + out->count, c, n < room ? n : room);
+  }
+  out->count += n;
+}
+
+// Most pieces are a few bytes long and fit, so that case is copied inline
+// and everything else goes to s21_out_spill.
+static S21_INLINE void s21_out_write(s21_out *out, const char *src,
+                                     s21_size_t n) {
+  if (n <= 16 && out->count + n < out->size) {
+    char *dest = out->buf + out->count;
+    for (s21_size_t k = 0; k < n; k++) dest[k] = src[k];
+    out->count += n;
+  } else {
+    s21_out_spill(out, src, 0, n);
+  }
+}
+
+static S21_INLINE void s21_out_fill(s21_out *out, char c, s21_size_t n) {
+  if (n <= 16 && out->count + n < out->size) {
+    char *dest = out->buf + out->count;
+    for (s21_size_t k = 0; k < n; k++) dest[k] = c;
+    out->count += n;
+  } else {
+    s21_out_spill(out, s21_NULL, c, n);
+  }
+}
+
+// Number of characters written so far by this call.
+static S21_INLINE s21_size_t s21_out_total(const s21_out *out) {
+  return out->count + out->flushed - out->start;
+}
+
+// Null-terminates the output, or hands it back to the sink, and returns the
+// length s21_snprintf reports.
+static int s21_out_finish(s21_out *out) {
+  s21_size_t total = s21_out_total(out);
+  if (out->sink != s21_NULL) {
+    out->sink->len = out->count;
+    if (out->sink->error) return -1;
+  } else if (out->size > 0) {
+    out->buf[out->count < out->size ? out->count : out->size - 1] = '\0';
+  }
+  return total > INT_MAX ? -1 : (int)total;
+}
+
+// Writes one field: prefix (sign, 0x), zeros, then body, padded with spaces
+// to the field width on the side the '-' flag selects.
+static void s21_out_field(s21_out *out, const Format *form, const char *prefix,
+                          int prefix_len, int zeros, const char *body,
+                          s21_size_t len) {
+  s21_size_t used = prefix_len + zeros + len;
+  s21_size_t pad = (s21_size_t)form->width > used ? form->width - used : 0;
+  if (form->flag_m == 0 && pad > 0) s21_out_fill(out, ' ', pad);
+  if (prefix_len > 0) s21_out_write(out, prefix, prefix_len);
+  if (zeros > 0) s21_out_fill(out, '0', zeros);
+  s21_out_write(out, body, len);
+  if (form->flag_m == 1 && pad > 0) s21_out_fill(out, ' ', pad);
+}
+
+// Sign character of a signed conversion, or 0 for none.
+static int s21_sign_char(const Format *form) {
+  int sign = 0;
+  if (form->is_negative)
+    sign = '-';
+  else if (form->flag_p)
+    sign = '+';
+  else if (form->flag_s)
+    sign = ' ';
+  return sign;
+}
+
+static void s21_convert_int(s21_out *out, Format *form, unsigned long long num,
+                            int base) {
+  char digits[24];
+  char *end = digits + sizeof(digits), *p = end;
+  char prefix[2];
+  int prefix_len = 0, zeros = 0;
+  if (num != 0 || form->accuracy != 0) {
+    if (base == 10) {
+      p -= s21_dec_len(num);
+      s21_put_dec(end, num);
+    } else if (base == 16) {
+      p -= s21_hex_len(num);
+      s21_put_hex(end, num, form->spec == 'X');
+    } else {
+      unsigned long long value = num;
+      do {
+        *--p = (char)('0' + (value & 7));
+        value >>= 3;
+      } while (value);
     }
   }
+  int len = (int)(end - p);
+  if (form->accuracy > len) zeros = form->accuracy - len;
+  if (form->unsign == 0 && s21_sign_char(form))
+    prefix[prefix_len++] = (char)s21_sign_char(form);
+  if (form->spec == 'p' || (form->flag_r && num != 0 && base == 16)) {
+    prefix[prefix_len++] = '0';
+    prefix[prefix_len++] = form->spec == 'X' ? 'X' : 'x';
+  }
+  if (form->flag_r && base == 8 && zeros == 0 && (len == 0 || *p != '0'))
+    zeros = 1;
+  if (form->flag_z && form->flag_m == 0 && form->accuracy < 0 &&
+      form->width > prefix_len + zeros + len)
+    zeros = form->width - prefix_len - len;
+  s21_out_field(out, form, prefix, prefix_len, zeros, p, len);
 }
 
-char *s21_switch_spec(va_list *ap, s21_size_t j, Format *form) {
-  char *res = s21_NULL;
-  switch (form->spec) {
-    case 'n': {
-      res = s21_process_spec_n(ap, j);
-      break;
+static void s21_convert_signed(s21_out *out, va_list *ap, Format *form) {
+  long long num;
+  if (form->length == 'h' && form->length2 == 'h')
+    num = (signed char)va_arg(*ap, int);
+  else if (form->length == 'h')
+    num = (short)va_arg(*ap, int);
+  else if (form->length == 'l' && form->length2 == 'l')
+    num = va_arg(*ap, long long);
+  else if (form->length == 'l')
+    num = va_arg(*ap, long);
+  else
+    num = va_arg(*ap, int);
+  unsigned long long mag = (unsigned long long)num;
+  if (num < 0) {
+    form->is_negative = 1;
+    mag = 0 - mag;
+  }
+  s21_convert_int(out, form, mag, 10);
+}
+
+static void s21_convert_unsigned(s21_out *out, va_list *ap, Format *form) {
+  unsigned long long num;
+  int base = 10;
+  if (form->spec == 'x' || form->spec == 'X') base = 16;
+  if (form->spec == 'o') base = 8;
+  if (form->length == 'h' && form->length2 == 'h')
+    num = (unsigned char)va_arg(*ap, unsigned);
+  else if (form->length == 'h')
+    num = (unsigned short)va_arg(*ap, unsigned);
+  else if (form->length == 'l' && form->length2 == 'l')
+    num = va_arg(*ap, unsigned long long);
+  else if (form->length == 'l')
+    num = va_arg(*ap, unsigned long);
+  else
+    num = va_arg(*ap, unsigned);
+  form->unsign = 1;
+  s21_convert_int(out, form, num, base);
+}
+
+// Writes the digits of positions 10^top down to 10^(top - count + 1).
+static void s21_out_digits(s21_out *out, const s21_decimal *dec, int top,
+                           int count) {
+  int index = dec->exp - top;
+  if (index < 0) {
+    int lead = -index < count ? -index : count;
+    s21_out_fill(out, '0', lead);
+    count -= lead;
+    index = 0;
+  }
+  if (count > 0 && index < dec->len) {
+    int take = dec->len - index < count ? dec->len - index : count;
+    s21_out_write(out, dec->digits + index, take);
+    count -= take;
+  }
+  if (count > 0) s21_out_fill(out, '0', count);
+}
+
+// Number of digits of dec that are not trailing zeros.
+static int s21_decimal_trim(const s21_decimal *dec) {
+  int len = dec->len;
+  while (len > 0 && dec->digits[len - 1] == '0') len--;
+  return len;
+}
+
+// Lays out dec as [-]ddd.ddd (style 'f') or [-]d.ddde+dd (style 'e') with
+// frac digits after the point, padded to the field width.
+static void s21_out_decimal(s21_out *out, const Format *form,
+                            const s21_decimal *dec, char style, int frac,
+                            int upper) {
+  char prefix[1], exponent[8];
+  int prefix_len = 0, exp_len = 0, zeros = 0;
+  int point = frac > 0 || form->flag_r;
+  int int_len = style == 'f' && dec->exp > 0 ? dec->exp + 1 : 1;
+  if (s21_sign_char(form)) prefix[prefix_len++] = (char)s21_sign_char(form);
+  if (style == 'e') {
+    int e = dec->len > 0 ? dec->exp : 0;
+    char digits[8];
+    exponent[exp_len++] = upper ? 'E' : 'e';
+    exponent[exp_len++] = e < 0 ? '-' : '+';
+    int len = (int)s21_u64toa(e < 0 ? -e : e, digits);
+    if (len < 2) exponent[exp_len++] = '0';
+    for (int k = 0; k < len; k++) exponent[exp_len++] = digits[k];
+  }
+  s21_size_t len = prefix_len + int_len + point + frac + exp_len;
+  s21_size_t pad = (s21_size_t)form->width > len ? form->width - len : 0;
+  if (form->flag_z && form->flag_m == 0) {
+    zeros = (int)pad;
+    pad = 0;
+  }
+  if (form->flag_m == 0 && pad > 0) s21_out_fill(out, ' ', pad);
+  s21_out_write(out, prefix, prefix_len);
+  s21_out_fill(out, '0', zeros);
+  if (style == 'f') {
+    s21_out_digits(out, dec, int_len - 1, int_len);
+    if (point) s21_out_write(out, ".", 1);
+    s21_out_digits(out, dec, -1, frac);
+  } else {
+    int top = dec->len > 0 ? dec->exp : 0;
+    s21_out_digits(out, dec, top, 1);
+    if (point) s21_out_write(out, ".", 1);
+    s21_out_digits(out, dec, top - 1, frac);
+    s21_out_write(out, exponent, exp_len);
+  }
+  if (form->flag_m == 1 && pad > 0) s21_out_fill(out, ' ', pad);
+}
+
+// Digits of a finite double for one conversion. Results that fit in 64 bits
+// come from one 128-bit product. Otherwise Ryu gives the shortest digits;
+// with no more than 15 of them they are also the correctly rounded digits of
+// any longer form up to 15 digits, so only the rest go through s21_exact.
+static void s21_float_digits(s21_decimal *dec, long double value, int is_long,
+                             int count, int fixed) {
+  uint64_t mant;
+  int exp2, ieee_exp = -1;
+  if (is_long && LDBL_MANT_DIG != 53) {
+    int e;
+    long double frac = frexpl(fabsl(value), &e);
+    mant = (uint64_t)ldexpl(frac, 64);
+    exp2 = e - 64;
+  } else {
+    union {
+      double d;
+      uint64_t u;
+    } bits = {(double)value};
+    ieee_exp = (int)((bits.u >> 52) & 0x7ff);
+    mant = bits.u & ((1ULL << 52) - 1);
+    exp2 = ieee_exp ? ieee_exp - 1075 : -1074;
+    if (ieee_exp != 0) mant |= 1ULL << 52;
+  }
+  int done = 0;
+  if (mant != 0 && count >= 0)
+    done = s21_scaled_digits(dec, mant, exp2, count, fixed);
+  if (!done && mant != 0 && ieee_exp >= 0) {
+    int e10;
+    uint64_t digits = s21_shortest(mant & ((1ULL << 52) - 1), ieee_exp, &e10);
+    int len = s21_dec_len(digits);
+    int n = fixed ? e10 + len + count : count;
+    // Subnormals carry fewer bits, so only the shortest form is safe.
+    if (count < 0 || (ieee_exp != 0 && len <= n && n <= 15)) {
+      s21_put_dec(dec->digits + len, digits);
+      dec->len = len;
+      dec->exp = e10 + len - 1;
+      done = 1;
+    }
+  }
+  if (!done && count < 0 && ieee_exp < 0 && mant != 0) {
+    s21_shortest_exact(dec, mant, exp2);
+  } else if (!done && count < 0) {
+    dec->len = 0;
+    dec->exp = 0;
+  } else if (!done) {
+    s21_exact(dec, mant, exp2, count, fixed);
+  }
+}
+
+static void s21_out_float(s21_out *out, Format *form, long double value,
+                          int is_long) {
+  int upper = form->spec >= 'A' && form->spec <= 'Z';
+  char spec = (char)(form->spec | 0x20);
+  int precision = form->accuracy < 0 ? 6 : form->accuracy;
+  s21_decimal dec;
+  if (signbit(value)) form->is_negative = 1;
+  if (isnan(value) || isinf(value)) {
+    const char *text = isnan(value) ? (upper ? "NAN" : "nan")
+                                     : (upper ? "INF" : "inf");
+    char prefix[1];
+    int prefix_len = 0;
+    if (s21_sign_char(form)) prefix[prefix_len++] = (char)s21_sign_char(form);
+    s21_out_field(out, form, prefix, prefix_len, 0, text, 3);
+  } else if (spec == 'f') {
+    s21_float_digits(&dec, value, is_long, precision, 1);
+    s21_out_decimal(out, form, &dec, 'f', precision, upper);
+  } else if (spec == 'e') {
+    s21_float_digits(&dec, value, is_long, precision + 1, 0);
+    s21_out_decimal(out, form, &dec, 'e', precision, upper);
+  } else {
+    // %g rounds to P significant digits and %r takes the shortest ones, or
+    // rounds to P when a precision asks for fewer; both then pick fixed or
+    // exponential notation from the exponent X.
+    int p = precision == 0 ? 1 : precision;
+    if (spec == 'r' && form->accuracy < 0) p = 17;
+    if (spec == 'g') {
+      s21_float_digits(&dec, value, is_long, p, 0);
+    } else {
+      s21_float_digits(&dec, value, is_long, -1, 0);
+      if (form->accuracy >= 0 && s21_decimal_trim(&dec) > p)
+        s21_float_digits(&dec, value, is_long, p, 0);
     }
+    int x = dec.len > 0 ? dec.exp : 0;
+    int digits = form->flag_r && spec == 'g' ? p : s21_decimal_trim(&dec);
+    if (digits == 0) digits = 1;
+    if (x < p && x >= -4)
+      s21_out_decimal(out, form, &dec, 'f', digits > x + 1 ? digits - 1 - x : 0,
+                      upper);
+    else
+      s21_out_decimal(out, form, &dec, 'e', digits - 1, upper);
+  }
+}
+
+static void s21_convert_float(s21_out *out, va_list *ap, Format *form) {
+  if (form->length == 'L')
+    s21_out_float(out, form, va_arg(*ap, long double), 1);
+  else
+    s21_out_float(out, form, va_arg(*ap, double), 0);
+}
+
+s21_size_t s21_dtoa(double value, char *buf) {
+  s21_out out = {buf, 32, 0, s21_NULL, 0, 0};
+  Format form = {0, 0, 0, 0, 0, 0, -1, '\0', '\0', 0, 0, 'r', 0};
+  s21_out_float(&out, &form, value, 0);
+  return (s21_size_t)s21_out_finish(&out);
+}
+
+static void s21_convert_string(s21_out *out, va_list *ap, Format *form) {
+  const char *str = va_arg(*ap, const char *);
+  s21_size_t len;
+  if (str == s21_NULL) str = "(null)";
+  if (form->accuracy >= 0) {
+    // The string may be shorter than the precision and end right before
+    // an unmapped page; s21_memchr reads nothing past the terminator's
+    // aligned block.
+    const char *end = s21_memchr(str, '\0', form->accuracy);
+    len = end ? (s21_size_t)(end - str) : (s21_size_t)form->accuracy;
+  } else {
+    len = s21_strlen(str);
+  }
+  s21_out_field(out, form, s21_NULL, 0, 0, str, len);
+}
+
+static void s21_store_count(va_list *ap, const Format *form,
+                            s21_size_t count) {
+  if (form->length == 'h' && form->length2 == 'h')
+    *va_arg(*ap, signed char *) = (signed char)count;
+  else if (form->length == 'h')
+    *va_arg(*ap, short *) = (short)count;
+  else if (form->length == 'l' && form->length2 == 'l')
+    *va_arg(*ap, long long *) = (long long)count;
+  else if (form->length == 'l')
+    *va_arg(*ap, long *) = (long)count;
+  else
+    *va_arg(*ap, int *) = (int)count;
+}
+
+// Converts one parsed directive straight into the output. Returns 0 for an
+// unknown specifier, which the caller copies through as text.
+static int s21_convert(s21_out *out, va_list *ap, Format *form) {
+  int known = 1;
+  switch (form->spec) {
     case 'i':
-    case 'd': {
-      res = s21_process_spec_id(ap, form);
+    case 'd':
+      s21_convert_signed(out, ap, form);
       break;
-    }
     case 'X':
     case 'x':
     case 'u':
-    case 'o': {
-      res = s21_process_spec_xuo(ap, form);
-      break;
-    }
-    case 'p': {
-      res = s21_process_spec_p(ap, form);
+    case 'o':
+      s21_convert_unsigned(out, ap, form);
       break;
-    }
-    case 'f': {
-      res = s21_process_spec_f(ap, form);
+    case 'p':
+      form->unsign = 1;
+      s21_convert_int(out, form, (uintptr_t)va_arg(*ap, void *), 16);
       break;
-    }
+    case 'f':
+    case 'F':
     case 'E':
-    case 'e': {
-      res = s21_process_spec_e(ap, form);
-      break;
-    }
+    case 'e':
     case 'G':
-    case 'g': {
-      res = s21_process_spec_g(ap, form);
+    case 'g':
+    case 'R':
+    case 'r':
+      s21_convert_float(out, ap, form);
       break;
-    }
     case 'c': {
-      res = s21_process_spec_c(ap, form);
+      char c = (char)va_arg(*ap, int);
+      s21_out_field(out, form, s21_NULL, 0, 0, &c, 1);
       break;
     }
-    case 's': {
-      res = s21_process_spec_s(ap, form);
+    case 's':
+      s21_convert_string(out, ap, form);
+      break;
+    case '%':
+      s21_out_write(out, "%", 1);
+      break;
+    case 'n':
+      s21_store_count(ap, form, s21_out_total(out));
       break;
-    }
     default:
+      known = 0;
       break;
   }
-  return res;
+  return known;
 }
 
-char *s21_process_spec_n(va_list *ap, s21_size_t j) {
-  int *n = va_arg(*ap, int *);
-  *n = j;
-  char *res = calloc(1, sizeof(char));
+int s21_sprintf(char *str, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vsnprintf(str, (s21_size_t)-1, format, ap);
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_id(va_list *ap, Format *form) {
-  int base = 10;
-  char *res = s21_NULL;
-  if (form->length == 'h' && form->length2 != 'h')
-    res = s21_itoa((short)va_arg(*ap, int), base, form);
-  else if (form->length == 'h' && form->length2 == 'h')
-    res = s21_itoa((signed char)va_arg(*ap, int), base, form);
-  else if (form->length == 'l' && form->length2 != 'l')
-    res = s21_itoa(va_arg(*ap, long int), base, form);
-  else if (form->length == 'l' && form->length2 == 'l')
-    res = s21_itoa(va_arg(*ap, long long int), base, form);
-  else
-    res = s21_itoa(va_arg(*ap, int), base, form);
+int s21_snprintf(char *str, s21_size_t size, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vsnprintf(str, size, format, ap);
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_xuo(va_list *ap, Format *form) {
-  form->unsign = 1;
-  char *res = s21_NULL;
-  int base = 10;
-  if (form->spec == 'x' || form->spec == 'X') base = 16;
-  if (form->spec == 'o') base = 8;
-  if (form->length == 'h' && form->length2 != 'h')
-    res = s21_itoa((unsigned short)va_arg(*ap, int), base, form);
-  else if (form->length == 'h' && form->length2 == 'h')
-    res = s21_itoa((unsigned char)va_arg(*ap, int), base, form);
-  else if (form->length == 'l' && form->length2 != 'l')
-    res = s21_itoa(va_arg(*ap, unsigned long), base, form);
-  else if (form->length == 'l' && form->length2 == 'l')
-    res = s21_itoa(va_arg(*ap, unsigned long long), base, form);
-  else
-    res = s21_itoa(va_arg(*ap, unsigned int), base, form);
+int s21_vsprintf(char *str, const char *format, va_list ap) {
+  return s21_vsnprintf(str, (s21_size_t)-1, format, ap);
+}
+
+// Formats into out. Returns -1 for a format that ends inside a directive,
+// and 0 otherwise.
+static int s21_out_format(s21_out *out, const char *format, va_list args) {
+  s21_size_t i = 0;
+  int res = 0;
+  va_list ap;
+  // A va_list parameter may be an array that decayed to a pointer, so the
+  // helpers get the address of a local copy instead.
+  va_copy(ap, args);
+  while (format[i] != '\0' && res == 0) {
+    if (format[i] != '%') {
+      s21_size_t lit = i + 1;
+      while (format[lit] != '\0' && format[lit] != '%') lit++;
+      s21_out_write(out, &format[i], lit - i);
+      i = lit;
+      continue;
+    }
+    s21_size_t start = i++;
+    Format form = {0, 0, 0, 0, 0, 0, -1, '\0', '\0', 0, 0, '\0', 0};
+    while (format[i] && format[i] == ' ' && format[i + 1] == ' ') i++;
+    s21_parse_flags(format, &i, &form);
+    s21_parse_width(&ap, format, &i, &form);
+    s21_parse_accuracy(&ap, format, &i, &form);
+    s21_parse_length(format, &i, &form);
+    form.spec = format[i];
+    if (form.spec == '\0') {
+      res = -1;
+    } else {
+      i++;
+      if (!s21_convert(out, &ap, &form))
+        s21_out_write(out, &format[start], i - start);
+    }
+  }
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_p(va_list *ap, Format *form) {
-  char *res = s21_NULL;
-  form->flag_r = 1;
-  res = s21_itoa(va_arg(*ap, unsigned long long int), 16, form);
+int s21_vsnprintf(char *str, s21_size_t size, const char *format,
+                  va_list args) {
+  s21_out out = {str, str == s21_NULL ? 0 : size, 0, s21_NULL, 0, 0};
+  int res = s21_out_format(&out, format, args);
+  if (res == 0) res = s21_out_finish(&out);
   return res;
 }
 
-char *s21_process_spec_f(va_list *ap, Format *form) {
-  char *res = s21_NULL;
-  if (form->accuracy < 0) form->accuracy = 6;
-  if (form->length == 'L')
-    res = s21_ftoa(va_arg(*ap, long double), form->accuracy, form);
-  else
-    res = s21_ftoa(va_arg(*ap, double), form->accuracy, form);
+// SINKS
+
+// Appends n bytes of src, or n copies of c when src is NULL, flushing
+// whenever the buffer is full.
+static void s21_sink_put(s21_sink *sink, const char *src, char c,
+                         s21_size_t n) {
+  while (n > 0 && sink->error == 0) {
+    if (sink->len == sink->size &&
+        (sink->flush(sink, n) != 0 || sink->len == sink->size)) {
+      sink->error = -1;
+    } else {
+      s21_size_t room = sink->size - sink->len;
+      s21_size_t take = n < room ? n : room;
+      if (src != s21_NULL) {
+        s21_memcpy(sink->buf + sink->len, src, take);
+        src += take;
+      } else {
+        s21_memset(sink->buf + sink->len, c, take);
+      }
+      sink->len += take;
+      n -= take;
+    }
+  }
+}
+
+static int s21_sink_fd_flush(s21_sink *sink, s21_size_t need) {
+  s21_size_t done = 0;
+  (void)need;
+  while (done < sink->len) {
+    ssize_t res = write(sink->fd, sink->buf + done, sink->len - done);
+    if (res < 0 && errno == EINTR) continue;
+    if (res <= 0) return -1;
+    done += (s21_size_t)res;
+  }
+  sink->len = 0;
+  return 0;
+}
+
+static int s21_sink_file_flush(s21_sink *sink, s21_size_t need) {
+  (void)need;
+  if (fwrite(sink->buf, 1, sink->len, (FILE *)sink->ctx) != sink->len)
+    return -1;
+  sink->len = 0;
+  return 0;
+}
+
+// Grows the buffer to fit need more bytes, by half its size at least so
+// that appending stays amortised linear.
+static int s21_sink_mem_flush(s21_sink *sink, s21_size_t need) {
+  s21_size_t size = sink->size + sink->size / 2;
+  if (need == 0) return 0;
+  if (size < sink->len + need) size = sink->len + need;
+  if (size < 64) size = 64;
+  char *buf = s21_realloc(sink->buf, size);
+  if (buf == s21_NULL) return -1;
+  sink->buf = buf;
+  sink->size = size;
+  return 0;
+}
+
+void s21_sink_init(s21_sink *sink, int (*flush)(s21_sink *, s21_size_t),
+                   void *ctx, char *buf, s21_size_t size) {
+  sink->buf = buf;
+  sink->size = size;
+  sink->len = 0;
+  sink->flush = flush;
+  sink->ctx = ctx;
+  sink->fd = -1;
+  sink->error = 0;
+}
+
+void s21_sink_fd(s21_sink *sink, int fd, char *buf, s21_size_t size) {
+  s21_sink_init(sink, s21_sink_fd_flush, s21_NULL, buf, size);
+  sink->fd = fd;
+}
+
+void s21_sink_file(s21_sink *sink, FILE *stream, char *buf, s21_size_t size) {
+  s21_sink_init(sink, s21_sink_file_flush, stream, buf, size);
+}
+
+void s21_sink_mem(s21_sink *sink) {
+  s21_sink_init(sink, s21_sink_mem_flush, s21_NULL, s21_NULL, 0);
+}
+
+int s21_sink_write(s21_sink *sink, const char *data, s21_size_t len) {
+  s21_sink_put(sink, data, 0, len);
+  return sink->error;
+}
+
+int s21_sink_flush(s21_sink *sink) {
+  if (sink->error == 0 && sink->len > 0 && sink->flush(sink, 0) != 0)
+    sink->error = -1;
+  return sink->error;
+}
+
+int s21_sink_printf(s21_sink *sink, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_sink_vprintf(sink, format, ap);
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_e(va_list *ap, Format *form) {
-  char *res = s21_NULL;
-  if (form->accuracy == -1) form->accuracy = 6;
-  if (form->length == 'L')
-    res = s21_ftoexp(va_arg(*ap, long double), form);
-  else
-    res = s21_ftoexp(va_arg(*ap, double), form);
+int s21_sink_vprintf(s21_sink *sink, const char *format, va_list ap) {
+  s21_out out = {sink->buf, sink->size + 1, sink->len, sink, sink->len, 0};
+  int res = sink->error;
+  if (res == 0) res = s21_out_format(&out, format, ap);
+  int len = s21_out_finish(&out);
+  return res == 0 ? len : -1;
+}
+
+int s21_fprintf(FILE *stream, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vfprintf(stream, format, ap);
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_g(va_list *ap, Format *form) {
-  char *res = s21_NULL;
-  if (form->accuracy == -1) form->accuracy = 6;
-  if (form->length == 'L')
-    res = s21_ftog(va_arg(*ap, long double), form);
-  else
-    res = s21_ftog(va_arg(*ap, double), form);
+int s21_vfprintf(FILE *stream, const char *format, va_list ap) {
+  char buf[4096];
+  s21_sink sink;
+  s21_sink_file(&sink, stream, buf, sizeof(buf));
+  int res = s21_sink_vprintf(&sink, format, ap);
+  return s21_sink_flush(&sink) == 0 ? res : -1;
+}
+
+int s21_dprintf(int fd, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vdprintf(fd, format, ap);
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_c(va_list *ap, Format *form) {
-  char *res = s21_NULL;
-  int c = va_arg(*ap, int);
-  int bytes = ((c >> 16 > 0) ? 4 : (c >> 12 > 0) ? 3 : (c >> 8 > 0) ? 2 : 1);
-  res = calloc(abs(form->width) + bytes + 1, sizeof(char));
-  res[0] = c;
+int s21_vdprintf(int fd, const char *format, va_list ap) {
+  char buf[4096];
+  s21_sink sink;
+  s21_sink_fd(&sink, fd, buf, sizeof(buf));
+  int res = s21_sink_vprintf(&sink, format, ap);
+  return s21_sink_flush(&sink) == 0 ? res : -1;
+}
+
+int s21_asprintf(char **strp, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vasprintf(strp, format, ap);
+  va_end(ap);
   return res;
 }
 
-char *s21_process_spec_s(va_list *ap, Format *form) {
-  char *res = s21_NULL;
-  char *tmp = va_arg(*ap, char *);
-  int len_dif = 0;
-  int acc = (int)s21_strlen(tmp);
-  if (form->accuracy > 0 && ((int)s21_strlen(tmp) - form->accuracy > 0)) {
-    len_dif = (int)s21_strlen(tmp) - form->accuracy;
-    acc = form->accuracy;
-  }
-  res = calloc((int)s21_strlen(tmp) - len_dif + form->width + 1, sizeof(char));
-  int k = 0;
-  while (tmp[k] != '\0' && k < acc) {
-    res[k] = tmp[k];
-    k++;
+// Formats once into a memory sink, so the buffer grows geometrically while
+// the conversions write into it, and is then cut to size by one realloc.
+int s21_vasprintf(char **strp, const char *format, va_list ap) {
+  s21_sink sink;
+  s21_sink_mem(&sink);
+  int res = s21_sink_vprintf(&sink, format, ap);
+  if (res >= 0 && s21_sink_write(&sink, "", 1) != 0) res = -1;
+  if (res < 0) {
+    s21_free(sink.buf);
+    *strp = s21_NULL;
+  } else {
+    char *str =
+        sink.size > sink.len ? s21_realloc(sink.buf, sink.len) : s21_NULL;
+    *strp = str != s21_NULL ? str : sink.buf;
   }
-  res[k] = '\0';
   return res;
 }
 
-void s21_reverse(char str[], int len) {
-  int start, end;
-  char temp;
-  for (start = 0, end = len - 1; start < end; start++, end--) {
-    temp = *(str + start);
-    *(str + start) = *(str + end);
-    *(str + end) = temp;
+int s21_asprintf_arena(s21_arena *arena, char **strp, const char *format,
+                       ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vasprintf_arena(arena, strp, format, ap);
+  va_end(ap);
+  return res;
+}
+
+// Formats straight into the free end of the current chunk and only takes
+// the block once the length is known; a string that does not fit is
+// formatted a second time into a block of its own.
+int s21_vasprintf_arena(s21_arena *arena, char **strp, const char *format,
+                        va_list ap) {
+  s21_size_t room;
+  char *str = s21_arena_space(arena, &room);
+  va_list again;
+  va_copy(again, ap);
+  int res = s21_vsnprintf(str, room, format, ap);
+  if (res >= 0) {
+    int fits = (s21_size_t)res < room;
+    str = s21_arena_alloc(arena, (s21_size_t)res + 1);
+    if (str == s21_NULL)
+      res = -1;
+    else if (!fits)
+      s21_vsnprintf(str, (s21_size_t)res + 1, format, again);
   }
+  va_end(again);
+  *strp = res >= 0 ? str : s21_NULL;
+  return res;
+}
+
+// BUILDER
+
+void s21_builder_init(s21_builder *b) { s21_sink_mem(&b->sink); }
+
+int s21_builder_reserve(s21_builder *b, s21_size_t n) {
+  s21_sink *sink = &b->sink;
+  if (sink->error == 0 && sink->size - sink->len < n &&
+      sink->flush(sink, n) != 0)
+    sink->error = -1;
+  return sink->error;
 }
 
-long long s21_atoi(char *str) {
-  long long res = 0;
-  for (int i = 0; str[i] != '\0'; ++i) {
-    res = res * 10 + str[i] - '0';
+int s21_builder_append(s21_builder *b, const char *data, s21_size_t n) {
+  s21_sink *sink = &b->sink;
+  if (sink->error == 0 && sink->size - sink->len >= n) {
+    s21_memcpy(sink->buf + sink->len, data, n);
+    sink->len += n;
+  } else {
+    s21_sink_put(sink, data, 0, n);
   }
+  return sink->error;
+}
+
+int s21_builder_append_cstr(s21_builder *b, const char *str) {
+  return s21_builder_append(b, str, s21_strlen(str));
+}
+
+int s21_builder_append_char(s21_builder *b, char c) {
+  return s21_builder_append(b, &c, 1);
+}
+
+// Converts straight into the buffer, which s21_i64toa needs 21 bytes of,
+// the null character included.
+int s21_builder_append_int(s21_builder *b, long long value) {
+  if (s21_builder_reserve(b, 21) == 0)
+    b->sink.len += s21_i64toa(value, b->sink.buf + b->sink.len);
+  return b->sink.error;
+}
+
+int s21_builder_append_uint(s21_builder *b, unsigned long long value) {
+  if (s21_builder_reserve(b, 21) == 0)
+    b->sink.len += s21_u64toa(value, b->sink.buf + b->sink.len);
+  return b->sink.error;
+}
+
+int s21_builder_printf(s21_builder *b, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_sink_vprintf(&b->sink, format, ap);
+  va_end(ap);
   return res;
 }
 
-void s21_process_flags(char *str, Format *form) {
-  int len = s21_strlen(str);
-  int i = len;
-  int width = form->width;
-  char c = ' ';
-  s21_reverse(str, len);
-  if (form->flag_z == 0) {
-    if (form->flag_s == 1 || form->flag_p == 1 || form->flag_m == 1) {
-      if (form->flag_p == 1 && form->spec != 'u' && form->spec != 'c' &&
-          form->spec != 's' && form->spec != 'x' && form->spec != 'X' &&
-          form->spec != 'o' && form->is_negative == 0) {
-        str[i++] = '+';
-      }
+int s21_builder_vprintf(s21_builder *b, const char *format, va_list ap) {
+  return s21_sink_vprintf(&b->sink, format, ap);
+}
+
+s21_size_t s21_builder_len(const s21_builder *b) { return b->sink.len; }
+
+char *s21_builder_finish(s21_builder *b, s21_size_t *len) {
+  char *str = s21_NULL;
+  if (s21_builder_append_char(b, '\0') == 0) {
+    str = b->sink.buf;
+    if (len != s21_NULL) *len = b->sink.len - 1;
+  } else {
+    s21_free(b->sink.buf);
+  }
+  s21_builder_init(b);
+  return str;
+}
+
+void s21_builder_free(s21_builder *b) {
+  s21_free(b->sink.buf);
+  s21_builder_init(b);
+}
+
+// COMPILED FORMATS
+
+// One step of a compiled format: literal text, then a conversion unless
+// form.spec is '\0', which only the last step has.
+typedef struct {
+  s21_size_t lit;
+  s21_size_t lit_len;
+  Format form;
+  char width_arg;
+  char accuracy_arg;
+} s21_directive;
+
+struct s21_format {
+  s21_size_t count;
+  char *text;
+  s21_directive code[];
+};
+
+// Parses format into fmt->code and the unescaped literals into fmt->text.
+// Returns 0 for a format that ends inside a directive.
+static int s21_format_parse(s21_format_t *fmt, const char *format) {
+  s21_directive *d = fmt->code;
+  s21_size_t i = 0, t = 0;
+  int ok = 1;
+  d->lit = 0;
+  while (format[i] != '\0' && ok) {
+    if (format[i] != '%') {
+      fmt->text[t++] = format[i++];
+      continue;
     }
-    if (form->is_negative == 1) str[i++] = '-';
-  }
-  if (form->flag_z == 1) c = '0';
-  if (form->flag_r == 1) {
-    if (form->spec == 'p' && s21_atoi(str) == 0) {
-      i = 0;
-      str[i++] = '0';
-      str[i++] = 'x';
-      str[i++] = '0';
-    } else if ((form->spec == 'x' || form->spec == 'p') && s21_atoi(str) != 0) {
-      str[i++] = 'x';
-      str[i++] = '0';
-      width -= 2;
-    } else if (form->spec == 'X' && s21_atoi(str) != 0) {
-      str[i++] = 'X';
-      str[i++] = '0';
-      width -= 2;
-    } else if (form->spec == 'o') {
-      if (str[i - 1] != '0') {
-        str[i++] = '0';
-        width -= 1;
-      }
+    s21_size_t start = i++;
+    Format form = {0, 0, 0, 0, 0, 0, -1, '\0', '\0', 0, 0, '\0', 0};
+    char width_arg = 0, accuracy_arg = 0;
+    while (format[i] && format[i] == ' ' && format[i + 1] == ' ') i++;
+    s21_parse_flags(format, &i, &form);
+    // Star arguments are read when the format runs, so the parsers never
+    // see them here and need no va_list.
+    if (format[i] == '*') {
+      width_arg = 1;
+      i++;
+    } else {
+      s21_parse_width(s21_NULL, format, &i, &form);
+    }
+    if (format[i] == '.' && format[i + 1] == '*') {
+      accuracy_arg = 1;
+      i += 2;
+    } else {
+      s21_parse_accuracy(s21_NULL, format, &i, &form);
+    }
+    s21_parse_length(format, &i, &form);
+    form.spec = format[i];
+    if (form.spec == '\0') {
+      ok = 0;
+    } else if (form.spec == '%' && !width_arg && !accuracy_arg) {
+      fmt->text[t++] = '%';
+      i++;
+    } else if (s21_strchr("diuxXopfFeEgGrRcsn%", form.spec) == s21_NULL) {
+      // Unknown directives print as written, as in s21_vsnprintf.
+      s21_memcpy(&fmt->text[t], &format[start], i + 1 - start);
+      t += i + 1 - start;
+      i++;
+    } else {
+      d->lit_len = t - d->lit;
+      d->form = form;
+      d->width_arg = width_arg;
+      d->accuracy_arg = accuracy_arg;
+      (++d)->lit = t;
+      i++;
     }
-    str[i] = '\0';
-  }
-  if (form->unsign == 1) form->is_negative = 0;
-  if ((form->is_negative == 1 || form->flag_p == 1) && form->spec != 's' &&
-      form->spec != 'c' && form->spec != 'u') {
-    width = width - len - 1;
-  } else {
-    width -= len;
   }
-  if (form->flag_m == 0 && width > 0) {
-    while (width > 0) {
-      if (width == 1 && form->flag_s == 1 && form->flag_z == 1)
-        str[i++] = ' ';
-      else
-        str[i++] = c;
-      width--;
-    }
-  } else if (width <= 0 && form->flag_s == 1 && form->is_negative == 0 &&
-             form->flag_p == 0 && form->spec != 'c' && form->spec != 's' &&
-             form->spec != 'u') {
-    str[i++] = ' ';
-  }
-  if (form->flag_z == 1) {
-    if (form->flag_s == 1 || form->flag_p == 1 || form->flag_m == 1) {
-      if (form->flag_p == 1 && form->spec != 'u' && form->spec != 'c' &&
-          form->spec != 's' && form->is_negative == 0)
-        str[i++] = '+';
-    }
-    if (form->is_negative == 1) str[i++] = '-';
-  }
-  str[i] = '\0';
-  s21_reverse(str, i);
-  if (form->flag_m == 1) {
-    while (width > 0) {
-      str[i++] = c;
-      width--;
-    }
-  }
-  str[i] = '\0';
-}
-
-char *s21_itoa(long long num, int base, Format *form) {
-  int i = 0;
-  int flag = 0;
-  s21_size_t temp_num = num;
-  char upper_letter = (form->spec == 'X') ? 'A' : 'a';
-  char *temp_str = calloc(BUFFERSIZE, sizeof(char));
-  if (temp_num == 0) {
-    if (form->accuracy == 0 && form->spec != 'f') {
-      temp_str[i] = '\0';
-      flag = 1;
-    } else if (form->spec == 'g' || form->spec == 'G') {
-      temp_str[i] = '0';
-      temp_str[i + 1] = '\0';
-      flag = 2;
-    }
-  }
-  if (!flag) {
-    if (num < 0 && base == 10 && form->float_part == 0) {
-      form->is_negative = 1;
-      if (form->unsign == 0) temp_num = -num;
-    }
-    while (temp_num) {
-      int rem = temp_num % base;
-      temp_str[i++] = (rem > 9) ? (rem - 10) + upper_letter : rem + '0';
-      temp_num /= base;
-    }
-    if (s21_strchr("xXouid", form->spec) != s21_NULL) {
-      int acc = form->accuracy;
-      if (acc > 0) acc -= (int)s21_strlen(temp_str);
-      while (acc > 0) {
-        temp_str[i++] = '0';
-        acc--;
+  d->lit_len = t - d->lit;
+  d->form.spec = '\0';
+  fmt->count = d - fmt->code + 1;
+  return ok;
+}
+
+s21_format_t *s21_format_compile(const char *format) {
+  s21_format_t *fmt = s21_NULL;
+  if (format != s21_NULL) {
+    s21_size_t len = s21_strlen(format), n = 1;
+    for (s21_size_t k = 0; k < len; k++) n += format[k] == '%';
+    fmt = s21_malloc(sizeof(*fmt) + n * sizeof(s21_directive) + len + 1);
+    if (fmt != s21_NULL) {
+      fmt->text = (char *)(fmt->code + n);
+      if (!s21_format_parse(fmt, format)) {
+        s21_free(fmt);
+        fmt = s21_NULL;
       }
-      if (s21_strchr("xXo", form->spec) != s21_NULL) form->flag_z = 0;
     }
-    if (num == 0 && form->spec == 'f') temp_str[i++] = '0';
-    temp_str[i] = '\0';
-    s21_reverse(temp_str, i);
   }
-  return temp_str;
+  return fmt;
 }
 
-char *s21_ftoa(long double f, int acc, Format *form) {
-  int accuracy = acc;
-  char *str = s21_NULL, *part = s21_NULL;
-  long long int int_part;
-  if (acc > 0) f = roundl(f * pow(10, acc)) / pow(10, acc);
-  if (signbit(f)) {
-    form->is_negative = 1;
-    f = -f;
-  }
-  if (acc > 0)
-    int_part = (long long int)(f + EPSILON_VALUE);
-  else
-    int_part = (long long int)(roundl(f) + EPSILON_VALUE);
-  long double float_part = f - (long double)int_part;
-  if (float_part < 0) {
-    float_part = -float_part;
-  }
-  str = s21_itoa(int_part, 10, form);
-  s21_size_t len = s21_strlen(str);
-  if (acc == 0 && form->flag_r == 1) str[len] = '.';
-  if (acc > 0) {
-    str[len] = '.';
-    long long int temp_itoa = 0;
-    while (accuracy > 0) {
-      float_part *= 10;
-      accuracy--;
-    }
-    temp_itoa = (long long int)(float_part + 0.5f);
-    part = s21_itoa(temp_itoa, 10, form);
-    int part_len = (int)s21_strlen(part);
-    int i = part_len;
-    s21_reverse(part, part_len);
-    accuracy = acc - part_len;
-    while (accuracy > 0) {
-      part[i++] = '0';
-      accuracy--;
-    }
-    part[i] = '\0';
-    s21_reverse(part, i);
-    form->float_part = 0;
-    s21_strcpy(&str[++len], part);
-    free(part);
-  }
-  return str;
+int s21_format_snprintf(char *str, s21_size_t size, const s21_format_t *fmt,
+                        ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int res = s21_format_vsnprintf(str, size, fmt, ap);
+  va_end(ap);
+  return res;
 }
 
-void s21_delete_zero(char *str) {
-  int size_str = s21_strlen(str);
-  if (size_str > 0) {
-    while (str[size_str - 1] == '0' || str[size_str - 1] == '.') {
-      char c = str[size_str - 1];
-      str[size_str - 1] = '\0';
-      size_str--;
-      if ((size_str == 0) || c == '.' || (size_str == 1 && str[0] == '0'))
-        break;
+int s21_format_vsnprintf(char *str, s21_size_t size, const s21_format_t *fmt,
+                         va_list args) {
+  s21_out out = {str, str == s21_NULL ? 0 : size, 0, s21_NULL, 0, 0};
+  va_list ap;
+  va_copy(ap, args);
+  for (s21_size_t k = 0; k < fmt->count; k++) {
+    const s21_directive *d = &fmt->code[k];
+    s21_out_write(&out, fmt->text + d->lit, d->lit_len);
+    if (d->form.spec != '\0') {
+      Format form = d->form;
+      if (d->width_arg) {
+        form.width = va_arg(ap, int);
+        if (form.width < 0) {
+          form.width = -form.width;
+          form.flag_m = 1;
+        }
+      }
+      if (d->accuracy_arg) {
+        form.accuracy = va_arg(ap, int);
+        if (form.accuracy < 0) form.accuracy = -1;
+      }
+      s21_convert(&out, &ap, &form);
     }
   }
+  va_end(ap);
+  return s21_out_finish(&out);
 }
 
-char *s21_ftoexp(long double f, Format *form) {
-  char *str = s21_NULL;
-  long double temp = (long double)f;
-  s21_size_t i = 0;
-  long long int int_part = 0;
-  int e = 0;
-  if (signbit(temp)) {
-    temp = -temp;
-    form->is_negative = 1;
-  }
-  while (temp > 0) {
-    int_part = (long long int)(temp + EPSILON_VALUE);
-    if ((int_part > 0 && int_part < 10)) {
-      break;
-    } else if (int_part >= 10) {
-      temp /= 10;
-      e += 1;
-    } else if (int_part == 0) {
-      temp *= 10;
-      e -= 1;
-    }
-  }
-  Format s_temp = {form->flag_r, 0, 0, 0, 0, 0, -1, '\0', '\0', 0, 0, '\0', 0};
-  int ifg = 0;
-  str = s21_ftoa(temp, form->accuracy, &s_temp);
-  if (form->spec == 'g') {
-    if (form->flag_r == 0) s21_delete_zero(str);
-    form->spec = 'e';
-    ifg = 1;
-  }
-  if (form->spec == 'G') {
-    if (form->flag_r == 0) s21_delete_zero(str);
-    form->spec = 'E';
-    ifg = 1;
-  }
-  if (e != 0 || ifg == 0) {
-    i = s21_strlen(str);
-    str[i++] = form->spec;
-    if (e < 0)
-      str[i++] = '-';
+void s21_format_free(s21_format_t *fmt) { s21_free(fmt); }
+
+// SPRINTF FUNCTIONS
+
+void s21_parse_flags(const char *format, s21_size_t *i, Format *form) {
+  for (int more = 1; more;) {
+    char c = format[*i];
+    if (c == '#')
+      form->flag_r = 1;
+    else if (c == ' ')
+      form->flag_s = 1;
+    else if (c == '+')
+      form->flag_p = 1;
+    else if (c == '-')
+      form->flag_m = 1;
+    else if (c == '0')
+      form->flag_z = 1;
     else
-      str[i++] = '+';
-    char *tm = s21_itoa(e, 10, &s_temp);
-    if (s21_strlen(tm) < 2) str[i++] = '0';
-    s21_strcpy(&str[i], tm);
-    free(tm);
+      more = 0;
+    if (more) (*i)++;
   }
-  return str;
 }
 
-char *s21_ftog(long double f, Format *form) {
-  char *str = s21_NULL;
-  long double temp = (long double)f;
+void s21_parse_width(va_list *ap, const char *format, s21_size_t *i,
+                     Format *form) {
+  if (format[*i] == '-' || (format[*i] >= '0' && format[*i] <= '9')) {
+    if (format[*i] == '-') (*i)++;
+    while (format[*i] >= '0' && format[*i] <= '9') {
+      form->width = form->width * 10 + ((int)format[*i] - '0');
+      (*i)++;
+    }
+  } else if (format[*i] == '*') {
+    form->width = va_arg(*ap, int);
+    if (form->width < 0) {
+      form->width = -form->width;
+      form->flag_m = 1;
+    }
+    (*i)++;
+  }
+}
 
-  if (signbit(temp)) {
-    temp = -temp;
-    form->is_negative = 1;
+void s21_parse_accuracy(va_list *ap, const char *format, s21_size_t *i,
+                        Format *form) {
+  if (format[*i] == '.') {
+    (*i)++;
+    if (format[*i] == '*') {
+      form->accuracy = va_arg(*ap, int);
+      // A negative precision is taken as if it were omitted.
+      if (form->accuracy < 0) form->accuracy = -1;
+      (*i)++;
+    } else {
+      form->accuracy = 0;
+      while (format[*i] >= '0' && format[*i] <= '9') {
+        form->accuracy = form->accuracy * 10 + ((int)format[*i] - '0');
+        (*i)++;
+      }
+    }
   }
-  double tmp = temp;
-  if (tmp < 0) tmp = -tmp;
-  int count_c = 0;
-  if (tmp == 0) count_c = 1;
-  while (tmp >= 1) {
-    tmp = tmp / 10;
-    count_c++;
-  }
-  int pos_right = count_c;
-  while (temp < pow(10, pos_right) && temp != 0) pos_right--;
-  if (count_c > form->accuracy || pos_right < -4) {
-    if (form->accuracy > 0) form->accuracy--;
-    str = s21_ftoexp(f, form);
-  } else {
-    if (pos_right < 0 && form->accuracy < abs(pos_right))
-      form->accuracy = abs(pos_right);
-    str = s21_ftoa(f, form->accuracy - count_c, form);
-    if (form->flag_r == 0) s21_delete_zero(str);
+}
+
+void s21_parse_length(const char *format, s21_size_t *i, Format *form) {
+  if (format[*i] == 'h' || format[*i] == 'l' || format[*i] == 'L') {
+    form->length = format[*i];
+    (*i)++;
+    if (format[*i] == 'h' || format[*i] == 'l' || format[*i] == 'L') {
+      form->length2 = format[*i];
+      (*i)++;
+    }
   }
-  return str;
 }
 
 void clear_buffs(char **buffer, char **buffer2) {
@@ -0,0 +1,1149 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include "s21_simd.h"
+#include "s21_string.h"
+
+// INTEGER PARSING
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define S21_SWAR_DIGITS 1
+#else
+#define S21_SWAR_DIGITS 0
+#endif
+
+// isspace for the C locale, without the table lookup through a call.
+static S21_INLINE int s21_is_space(char c) {
+  return c == ' ' || (unsigned char)(c - '\t') < 5;
+}
+
+// Whether 8 bytes from p can be loaded at once. A load that stays inside
+// one 4 KiB page cannot fault, even when it reads past the terminator.
+static S21_INLINE int s21_can_load8(const char *p) {
+  return S21_SWAR_DIGITS && ((uintptr_t)p & 4095) <= 4096 - 8;
+}
+
+// The 8 bytes from p, which may run past the terminator on purpose; the
+// only caller check is s21_can_load8. Kept out of AddressSanitizer's view
+// like the strlen kernels, and left to the compiler to inline, as it will
+// not inline it into instrumented code.
+S21_NO_SANITIZE
+static inline uint64_t s21_load8(const char *p) { return S21_LOAD64(p); }
+
+// Whether all 8 bytes of a little-endian word are ASCII digits: the high
+// nibble of each byte is 3, also after adding 6 to the byte.
+static S21_INLINE int s21_is_8digits(uint64_t w) {
+  return ((w & 0xF0F0F0F0F0F0F0F0ULL) |
+          (((w + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+         0x3333333333333333ULL;
+}
+
+// Value of 8 ASCII digits, the first in the lowest byte. Neighbouring
+// digits are combined into pairs, then the pairs into two halves of four
+// digits with two multiplications.
+static S21_INLINE uint32_t s21_parse_8digits(uint64_t w) {
+  w -= 0x3030303030303030ULL;
+  w = w * 10 + (w >> 8);
+  w = ((w & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+       ((w >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >>
+      32;
+  return (uint32_t)w;
+}
+
+// Value of c as a digit, or 36 or more for anything else.
+static S21_INLINE unsigned s21_digit_value(char c) {
+  unsigned d = (unsigned char)c - '0';
+  if (d > 9) {
+    d = ((unsigned char)c | 0x20) - 'a';
+    d = d < 26 ? d + 10 : 36;
+  }
+  return d;
+}
+
+// Reads digits of base from p into *value, saturating at ULLONG_MAX with
+// *overflow set. Returns the end of the digits, p itself if there is none.
+static const char *s21_scan_digits(const char *p, int base,
+                                   unsigned long long *value, int *overflow) {
+  unsigned long long v = 0;
+  unsigned d;
+  if (base == 10) {
+    const char *start = p;
+    while (*p == '0') p++;
+    const char *first = p;
+    // Below 20 digits nothing can overflow, so up to 19 are read without
+    // checks, eight at a time where they are all digits.
+    uint64_t word;
+    while (p - first <= 11 && s21_can_load8(p) &&
+           s21_is_8digits(word = s21_load8(p))) {
+      v = v * 100000000 + s21_parse_8digits(word);
+      p += 8;
+    }
+    while ((d = (unsigned char)*p - '0') <= 9 && p - first < 19) {
+      v = v * 10 + d;
+      p++;
+    }
+    if (p == start) return p;
+  } else {
+    const char *start = p;
+    while ((d = s21_digit_value(*p)) < (unsigned)base &&
+           v <= (ULLONG_MAX - d) / base) {
+      v = v * base + d;
+      p++;
+    }
+    if (p == start) return p;
+  }
+  while ((d = s21_digit_value(*p)) < (unsigned)base) {
+    if (v > (ULLONG_MAX - d) / base) {
+      *overflow = 1;
+      v = ULLONG_MAX;
+    } else {
+      v = v * base + d;
+    }
+    p++;
+  }
+  *value = v;
+  return p;
+}
+
+// strtoull without the final errno and endptr handling: parses spaces, a
+// sign, a prefix and digits. Returns the end of the number, str when there
+// is none.
+static const char *s21_scan_integer(const char *str, int base,
+                                    unsigned long long *value, int *negative,
+                                    int *overflow) {
+  const char *p = str;
+  *value = 0;
+  *negative = 0;
+  *overflow = 0;
+  while (s21_is_space(*p)) p++;
+  if (*p == '-' || *p == '+') *negative = *p++ == '-';
+  if ((base == 0 || base == 16) && p[0] == '0' && (p[1] | 0x20) == 'x' &&
+      s21_digit_value(p[2]) < 16) {
+    p += 2;
+    base = 16;
+  } else if (base == 0) {
+    base = p[0] == '0' ? 8 : 10;
+  }
+  const char *end = s21_scan_digits(p, base, value, overflow);
+  return end == p ? str : end;
+}
+
+unsigned long long s21_strtoull(const char *str, char **endptr, int base) {
+  unsigned long long value = 0;
+  int negative = 0, overflow = 0;
+  const char *end = str;
+  if (base == 1 || base < 0 || base > 36)
+    errno = EINVAL;
+  else
+    end = s21_scan_integer(str, base, &value, &negative, &overflow);
+  if (endptr != s21_NULL) *endptr = (char *)end;
+  if (overflow) {
+    errno = ERANGE;
+    return ULLONG_MAX;
+  }
+  return negative ? 0 - value : value;
+}
+
+long long s21_strtoll(const char *str, char **endptr, int base) {
+  unsigned long long value = 0;
+  int negative = 0, overflow = 0;
+  const char *end = str;
+  if (base == 1 || base < 0 || base > 36)
+    errno = EINVAL;
+  else
+    end = s21_scan_integer(str, base, &value, &negative, &overflow);
+  if (endptr != s21_NULL) *endptr = (char *)end;
+  if (overflow || value > (unsigned long long)LLONG_MAX + negative) {
+    errno = ERANGE;
+    return negative ? LLONG_MIN : LLONG_MAX;
+  }
+  return negative ? (long long)(0 - value) : (long long)value;
+}
+
+// FLOAT PARSING
+
+// Significands of 5^q for -342 <= q <= 308, after Eisel and Lemire (2020):
+// 5^q scaled to [2^127, 2^128) and truncated, or for negative q the
+// reciprocal rounded up. Like the Ryu tables in s21_sprintf.c, one entry per
+// 26 powers is stored and the rest rebuilt by a multiplication with 5^b,
+// with 2-bit corrections that make the result equal to the full table.
+
+static const uint64_t s21_lemire_split[12][2] = {
+    {0x0000000000000000ULL, 0x8000000000000000ULL},
+    {0x0000000000000000ULL, 0xa56fa5b99019a5c8ULL},
+    {0x72a4904598d6d880ULL, 0xd5d238a4abe98068ULL},
+    {0x6e3569326c784337ULL, 0x8a2dbf142dfcc7abULL},
+    {0x58edec91ec2cb657ULL, 0xb2977ee300c50fe7ULL},
+    {0xa60dc059157491e5ULL, 0xe6d3102ad96cec1dULL},
+    {0xdd945a747bf26183ULL, 0x952ab45cfa97a0b2ULL},
+    {0x84576a1bb416a7ddULL, 0xc0cb28a98fcf3c7fULL},
+    {0xa7709a56ccdf8a82ULL, 0xf92e0c3537826145ULL},
+    {0xb24cf65b8612f81fULL, 0xa1075a24e4421730ULL},
+    {0x2d2b7569b0432d85ULL, 0xd01fef10a657842cULL},
+    {0x49ed8eabcccc485dULL, 0x867f59a9d4bed6c0ULL}};
+
+static const uint64_t s21_lemire_inv_split[14][2] = {
+    {0x95364afe032a819eULL, 0xc612062576589ddaULL},
+    {0xe546a8038efe4029ULL, 0x993fe2c6d07b7fabULL},
+    {0x290123e9aab23b68ULL, 0xed246723473e3813ULL},
+    {0x09ce6ebb40173744ULL, 0xb77ada0617e3bbcbULL},
+    {0xca8d3ffa1ef463c1ULL, 0x8df5efabc5979c8fULL},
+    {0xdf45f746b74abf39ULL, 0xdbac6c247d62a583ULL},
+    {0x5e9fcf4ccd211f4cULL, 0xa9f6d30a038d1dbcULL},
+    {0x4247cb9e59f71e6dULL, 0x8380dea93da4bc60ULL},
+    {0xa9942f5dcf7dfd09ULL, 0xcb7ddcdda26da268ULL},
+    {0x6f773fc3603db4a9ULL, 0x9d71ac8fada6c9b5ULL},
+    {0x6b43527578c1110fULL, 0xf3a20279ed56d48aULL},
+    {0xc605083704f5ecf2ULL, 0xbc807527ed3e12bcULL},
+    {0x79071b9b8a4be869ULL, 0x91d8a02bb6c10594ULL},
+    {0x82189c09a3a1ec21ULL, 0xe1afa13afbd14d6dULL}};
+
+static const uint32_t s21_lemire_offsets[20] = {
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x05000141,
+    0x50541401, 0x55505440, 0x51150501, 0x54514545, 0x54505115, 0x45554514,
+    0x59555556, 0x50440140, 0x51404040, 0x11550155, 0x00000055, 0x00000000,
+    0x05550144, 0x00000111};
+
+static const uint32_t s21_lemire_inv_offsets[22] = {
+    0x10004010, 0x44100144, 0x00000400, 0x55554100, 0x50115004, 0x50101551,
+    0x55150145, 0x55555555, 0x00005001, 0x00000000, 0x01040010, 0x45505000,
+    0x04041145, 0x55040050, 0x10511501, 0x00401404, 0x40000000, 0x00000400,
+    0x05140000, 0x45590005, 0x55555145, 0x00000011};
+
+#define S21_LEMIRE_STEP 26
+#define S21_LEMIRE_MIN_Q -342
+#define S21_LEMIRE_MAX_Q 308
+
+// Top 128 bits of the 128-bit base times m, for 1 < m < 2^64.
+static void s21_mul_top128(const uint64_t *base, uint64_t m, uint64_t *res) {
+  uint64_t h0, h1;
+  uint64_t r0 = s21_umul128(base[0], m, &h0);
+  uint64_t r1 = s21_umul128(base[1], m, &h1);
+  uint64_t mid = h0 + r1;
+  uint64_t top = h1 + (mid < h0);
+  int shift = 64 - S21_CLZLL(top);
+  res[0] = s21_shr128(r0, mid, shift);
+  res[1] = s21_shr128(mid, top, shift);
+}
+
+// Significand of 5^q as res[0] (low) and res[1] (high).
+static void s21_lemire_pow5(int q, uint64_t *res) {
+  const uint64_t *base;
+  uint32_t fix;
+  int b;
+  if (q >= 0) {
+    base = s21_lemire_split[q / S21_LEMIRE_STEP];
+    b = q % S21_LEMIRE_STEP;
+    fix = (s21_lemire_offsets[q / 16] >> ((q % 16) << 1)) & 3;
+  } else {
+    int i = -q, a = (i + S21_LEMIRE_STEP - 1) / S21_LEMIRE_STEP;
+    base = s21_lemire_inv_split[a - 1];
+    b = a * S21_LEMIRE_STEP - i;
+    fix = (s21_lemire_inv_offsets[(i - 1) / 16] >> (((i - 1) % 16) << 1)) & 3;
+  }
+  if (b == 0) {
+    res[0] = base[0];
+    res[1] = base[1];
+  } else {
+    s21_mul_top128(base, s21_pow5_table[b], res);
+  }
+  res[0] += fix;
+  res[1] += res[0] < fix;
+}
+
+// Bits of the double nearest to w * 10^q, for w > 0. The 128-bit product
+// of w and the significand of 5^q always has enough bits to round
+// correctly (Mushtak and Lemire, 2023), except for exact halfway cases,
+// which only small q can produce and which are settled by the low bits.
+static uint64_t s21_lemire(uint64_t w, int q) {
+  uint64_t pow5[2], lo, hi, mid;
+  if (q < S21_LEMIRE_MIN_Q) return 0;
+  if (q > S21_LEMIRE_MAX_Q) return 0x7FF0000000000000ULL;
+  int lz = S21_CLZLL(w);
+  w <<= lz;
+  s21_lemire_pow5(q, pow5);
+  lo = s21_umul128(w, pow5[1], &hi);
+  if ((hi & 0x1FF) == 0x1FF) {
+    s21_umul128(w, pow5[0], &mid);
+    lo += mid;
+    hi += lo < mid;
+  }
+  int upper = (int)(hi >> 63);
+  uint64_t mant = hi >> (upper + 9);
+  // floor(q * log2(10)) + 63, plus the exponent bias.
+  int exp2 = (int)(((152170 + 65536) * (int64_t)q) >> 16) + 63 + upper - lz +
+             1023;
+  if (exp2 <= 0) {
+    if (-exp2 + 1 >= 64) return 0;
+    mant >>= -exp2 + 1;
+    mant += mant & 1;
+    mant >>= 1;
+    // Rounding up may carry into the smallest normal exponent.
+    return mant;
+  }
+  if (lo <= 1 && q >= -4 && q <= 23 && (mant & 3) == 1 &&
+      mant << (upper + 9) == hi)
+    mant &= ~1ULL;
+  mant += mant & 1;
+  mant >>= 1;
+  if (mant >= 2ULL << 52) {
+    mant = 1ULL << 52;
+    exp2++;
+  }
+  if (exp2 >= 0x7FF) return 0x7FF0000000000000ULL;
+  return ((uint64_t)exp2 << 52) | (mant & ((1ULL << 52) - 1));
+}
+
+// Significant digits kept for the exact comparison. The halfway point
+// between two doubles has at most 767 significant digits, so any digits
+// past these only matter as a nonzero tail.
+#define S21_PARSE_DIGITS 800
+
+// Decimal number as read from the text: the first 19 significant digits in
+// w, and the power of ten that applies to them.
+typedef struct {
+  uint64_t w;
+  int exp10;
+  int truncated;
+  // Digits and point, for the exact comparison, and the end of the number.
+  const char *digits;
+  const char *digits_end;
+  const char *end;
+  int exponent;
+  int frac_len;
+} s21_decimal_text;
+
+static void s21_big_add_small(s21_big *a, uint32_t value) {
+  uint64_t carry = value;
+  for (int k = 0; carry != 0 && k < a->len; k++) {
+    carry += a->w[k];
+    a->w[k] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  if (carry != 0) a->w[a->len++] = (uint32_t)carry;
+}
+
+// Reads digits into *w, eight at a time where possible; w may wrap.
+static const char *s21_scan_run(const char *p, uint64_t *w) {
+  uint64_t v = *w;
+  uint64_t word;
+  unsigned d;
+  while (s21_can_load8(p) && s21_is_8digits(word = s21_load8(p))) {
+    v = v * 100000000 + s21_parse_8digits(word);
+    p += 8;
+  }
+  while ((d = (unsigned char)*p - '0') <= 9) {
+    v = v * 10 + d;
+    p++;
+  }
+  *w = v;
+  return p;
+}
+
+// Parses [digits][.digits][e[sign]digits] at p. Returns 0 without digits.
+static int s21_scan_decimal(const char *p, s21_decimal_text *dec) {
+  const char *int_start = p, *frac_start = s21_NULL;
+  int int_len, frac_len = 0, exponent = 0;
+  uint64_t w = 0;
+  p = s21_scan_run(p, &w);
+  int_len = (int)(p - int_start);
+  if (*p == '.') {
+    frac_start = ++p;
+    p = s21_scan_run(p, &w);
+    frac_len = (int)(p - frac_start);
+  }
+  if (int_len + frac_len == 0) return 0;
+  dec->digits = int_start;
+  dec->digits_end = p;
+  if ((*p | 0x20) == 'e') {
+    const char *q = p + 1;
+    int negative = *q == '-';
+    if (*q == '-' || *q == '+') q++;
+    if (isdigit((unsigned char)*q)) {
+      while (isdigit((unsigned char)*q)) {
+        // Beyond this every value is zero or infinite anyway.
+        if (exponent < 100000) exponent = exponent * 10 + (*q - '0');
+        q++;
+      }
+      if (negative) exponent = -exponent;
+      p = q;
+    }
+  }
+  dec->exponent = exponent;
+  dec->frac_len = frac_len;
+  dec->exp10 = exponent - frac_len;
+  dec->truncated = 0;
+  dec->w = w;
+  if (int_len + frac_len > 19) {
+    // Leading zeros do not count; with more than 19 significant digits
+    // only the first 19 are kept in w.
+    const char *q = int_start;
+    int significant = int_len + frac_len;
+    while (*q == '0' || *q == '.') {
+      if (*q == '0') significant--;
+      q++;
+    }
+    if (significant > 19) {
+      int kept = 0;
+      w = 0;
+      for (; kept < 19; q++) {
+        if (*q != '.') {
+          w = w * 10 + (uint64_t)(*q - '0');
+          kept++;
+        }
+      }
+      dec->w = w;
+      dec->exp10 = exponent - frac_len + significant - 19;
+      dec->truncated = 1;
+    }
+  }
+  dec->end = p;
+  return 1;
+}
+
+// Whether the exact value of the text is above (1), at (0) or below (-1)
+// the halfway point between the double with the given bits and the next.
+static int s21_compare_halfway(const s21_decimal_text *dec, uint64_t bits) {
+  s21_big r, s;
+  int kept = 0, tail = 0, ieee_exp = (int)(bits >> 52);
+  uint64_t mant = bits & ((1ULL << 52) - 1);
+  int exp2 = ieee_exp ? ieee_exp - 1075 : -1074;
+  uint32_t chunk = 0;
+  int chunk_len = 0, significant = 0;
+  if (ieee_exp) mant |= 1ULL << 52;
+  s21_big_set(&r, 0);
+  for (const char *p = dec->digits; p < dec->digits_end; p++) {
+    if (*p == '.' || (significant == 0 && *p == '0')) continue;
+    significant++;
+    if (kept == S21_PARSE_DIGITS) {
+      tail |= *p != '0';
+      continue;
+    }
+    chunk = chunk * 10 + (uint32_t)(*p - '0');
+    kept++;
+    if (++chunk_len == 9) {
+      s21_big_mul_small(&r, 1000000000u);
+      s21_big_add_small(&r, chunk);
+      chunk = 0;
+      chunk_len = 0;
+    }
+  }
+  if (chunk_len > 0) {
+    s21_big_mul_pow10(&r, chunk_len);
+    s21_big_add_small(&r, chunk);
+  }
+  // r * 10^exp10 against (2 * mant + 1) * 2^(exp2 - 1).
+  int exp10 = dec->exponent - dec->frac_len + significant - kept;
+  s21_big_set(&s, 2 * mant + 1);
+  if (exp10 >= 0)
+    s21_big_mul_pow10(&r, exp10);
+  else
+    s21_big_mul_pow10(&s, -exp10);
+  if (exp2 - 1 >= 0)
+    s21_big_shl(&s, exp2 - 1);
+  else
+    s21_big_shl(&r, 1 - exp2);
+  int res = s21_big_cmp(&r, &s);
+  return res == 0 && tail ? 1 : res;
+}
+
+// Bits of the double nearest to m * 2^exp2, where sticky marks nonzero
+// bits below m, halfway cases to even. *inexact is set when bits were lost.
+static uint64_t s21_make_double(uint64_t m, int exp2, int sticky,
+                                int *inexact) {
+  *inexact = sticky;
+  if (m == 0) return 0;
+  int lz = S21_CLZLL(m);
+  m <<= lz;
+  exp2 -= lz;
+  // m is now in [2^63, 2^64), so the biased exponent is exp2 + 63 + 1023.
+  *inexact = 1;
+  if (exp2 > 2000) return 0x7FF0000000000000ULL;
+  int biased = exp2 + 63 + 1023, shift = 11;
+  if (biased < 1) {
+    if (1 - biased > 53) return 0;
+    shift += 1 - biased;
+    biased = 0;
+  }
+  uint64_t mant = shift == 64 ? 0 : m >> shift;
+  uint64_t rem = shift == 64 ? m : m & ((1ULL << shift) - 1);
+  uint64_t half = 1ULL << (shift - 1);
+  *inexact = rem != 0 || sticky;
+  if (rem > half || (rem == half && (sticky || (mant & 1)))) mant++;
+  if (biased == 0) return mant;
+  if (mant == 2ULL << 52) {
+    mant >>= 1;
+    biased++;
+  }
+  if (biased >= 0x7FF) {
+    *inexact = 1;
+    return 0x7FF0000000000000ULL;
+  }
+  return ((uint64_t)biased << 52) | (mant & ((1ULL << 52) - 1));
+}
+
+// What a floating point text denotes, before it is rounded to a type.
+typedef struct {
+  enum { S21_FLOAT_DECIMAL, S21_FLOAT_HEX, S21_FLOAT_INF, S21_FLOAT_NAN } kind;
+  int negative;
+  s21_decimal_text dec;
+  // Hexadecimal numbers: m * 2^exp2, then the first bit below m and
+  // whether any later one is set.
+  uint64_t m;
+  int exp2;
+  int half;
+  int sticky;
+} s21_float_text;
+
+// Parses the hexadecimal significand and binary exponent after "0x". Keeps
+// the leading 64 bits of the significand in num->m and the rounding
+// information for the rest. Returns s21_NULL without digits; *partial is
+// set when a 'p' has no exponent digits.
+static const char *s21_scan_hex_float(const char *p, s21_float_text *num,
+                                      int *partial) {
+  uint64_t m = 0;
+  int exp2 = 0, seen = 0, point = 0, dropped = 0;
+  unsigned d;
+  num->half = num->sticky = 0;
+  for (;; p++) {
+    if (*p == '.' && !point) {
+      point = 1;
+      continue;
+    }
+    if ((d = s21_digit_value(*p)) >= 16) break;
+    seen = 1;
+    // The digit goes in as far as there is room at the top of m.
+    int room = m == 0 || S21_CLZLL(m) > 4 ? 4 : S21_CLZLL(m);
+    unsigned lost = d & ((1u << (4 - room)) - 1);
+    m = (m << room) | (d >> (4 - room));
+    exp2 += 4 - room - (point ? 4 : 0);
+    if (room < 4 && !dropped) {
+      num->half = (int)(lost >> (3 - room));
+      num->sticky = (lost & ((1u << (3 - room)) - 1)) != 0;
+      dropped = 1;
+    } else if (room < 4) {
+      num->sticky |= lost != 0;
+    }
+  }
+  if (!seen) return s21_NULL;
+  *partial = (*p | 0x20) == 'p';
+  if (*partial) {
+    const char *q = p + 1;
+    int negative = *q == '-', exponent = 0;
+    if (*q == '-' || *q == '+') q++;
+    if (isdigit((unsigned char)*q)) {
+      while (isdigit((unsigned char)*q)) {
+        if (exponent < 100000) exponent = exponent * 10 + (*q - '0');
+        q++;
+      }
+      exp2 += negative ? -exponent : exponent;
+      p = q;
+      *partial = 0;
+    }
+  }
+  num->m = m;
+  num->exp2 = exp2;
+  return p;
+}
+
+// Case-insensitive match of a lowercase word at p.
+static int s21_match_word(const char *p, const char *word) {
+  int k = 0;
+  while (word[k] != '\0' && (p[k] | 0x20) == word[k]) k++;
+  return word[k] == '\0' ? k : 0;
+}
+
+// Bits of the double a decimal number denotes. Exact small cases are one
+// floating point operation (Clinger, 1990); the rest take Eisel-Lemire, and
+// when more than 19 digits leave two candidates, an exact comparison.
+static uint64_t s21_decimal_to_double(const s21_decimal_text *dec) {
+  static const double exact_pow10[23] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  uint64_t bits;
+  if (dec->w == 0) return 0;
+  if (!dec->truncated && dec->w <= 1ULL << 53 && dec->exp10 >= -22 &&
+      dec->exp10 <= 22) {
+    union {
+      double d;
+      uint64_t u;
+    } value = {(double)dec->w};
+    if (dec->exp10 < 0)
+      value.d /= exact_pow10[-dec->exp10];
+    else
+      value.d *= exact_pow10[dec->exp10];
+    return value.u;
+  }
+  bits = s21_lemire(dec->w, dec->exp10);
+  if (dec->truncated && bits != s21_lemire(dec->w + 1, dec->exp10)) {
+    int cmp = s21_compare_halfway(dec, bits);
+    if (cmp > 0 || (cmp == 0 && (bits & 1))) bits++;
+  }
+  return bits;
+}
+
+// Reads a floating point number at str into *num and returns its end, str
+// when there is none. For sscanf, *tail is the length of an exponent
+// without digits after the number, like the "e+" of "1e+", or -1 when the
+// text is a longer form that does not complete, like "0x" or "infin".
+static const char *s21_scan_float_text(const char *str, s21_float_text *num,
+                                       int *tail) {
+  const char *p = str, *end = s21_NULL;
+  int len, partial = 0;
+  num->negative = 0;
+  while (s21_is_space(*p)) p++;
+  if (*p == '-' || *p == '+') num->negative = *p++ == '-';
+  if (p[0] == '0' && (p[1] | 0x20) == 'x') {
+    end = s21_scan_hex_float(p + 2, num, &partial);
+  }
+  *tail = 0;
+  if (end != s21_NULL) {
+    num->kind = S21_FLOAT_HEX;
+    if (partial) *tail = end[1] == '-' || end[1] == '+' ? 2 : 1;
+  } else if ((len = s21_match_word(p, "infinity")) != 0 ||
+             (len = s21_match_word(p, "inf")) != 0) {
+    num->kind = S21_FLOAT_INF;
+    end = p + len;
+    if (len == 3 && (*end | 0x20) == 'i') *tail = -1;
+  } else if ((len = s21_match_word(p, "nan")) != 0) {
+    num->kind = S21_FLOAT_NAN;
+    end = p + len;
+    if (*end == '(') {
+      const char *q = end + 1;
+      while (isalnum((unsigned char)*q) || *q == '_') q++;
+      if (*q == ')') end = q + 1;
+    }
+  } else {
+    s21_decimal_text *dec = &num->dec;
+    num->kind = S21_FLOAT_DECIMAL;
+    end = str;
+    if (s21_scan_decimal(p, dec)) {
+      end = dec->end;
+      if (end == dec->digits_end && (*end | 0x20) == 'e')
+        *tail = end[1] == '-' || end[1] == '+' ? 2 : 1;
+      if (end == p + 1 && *p == '0' && (*end | 0x20) == 'x') *tail = -1;
+    }
+  }
+  return end;
+}
+
+// strtod without errno and endptr: stores the value and returns the end of
+// the number, str when there is none, with *tail as s21_scan_float_text
+// sets it. *range is set when rounding gives infinity, zero or a
+// subnormal. A decimal subnormal is exact only with hundreds of digits, so
+// any nonzero decimal one counts as rounded.
+static const char *s21_scan_double(const char *str, double *value, int *range,
+                                   int *tail) {
+  s21_float_text num;
+  union {
+    double d;
+    uint64_t u;
+  } res = {0.0};
+  int inexact = 0;
+  const char *end = s21_scan_float_text(str, &num, tail);
+  if (end == str)
+    ;
+  else if (num.kind == S21_FLOAT_DECIMAL) {
+    res.u = s21_decimal_to_double(&num.dec);
+    inexact = num.dec.w != 0;
+  } else if (num.kind == S21_FLOAT_HEX) {
+    res.u = s21_make_double(num.m, num.exp2, num.half || num.sticky, &inexact);
+  } else {
+    res.u = num.kind == S21_FLOAT_INF ? 0x7FF0000000000000ULL
+                                      : 0x7FF8000000000000ULL;
+  }
+  int ieee_exp = (int)(res.u >> 52);
+  *range = inexact && (ieee_exp == 0 || ieee_exp == 0x7FF);
+  // Without a conversion the result is +0.0, whatever sign came first.
+  if (num.negative && end != str) res.u |= 1ULL << 63;
+  *value = res.d;
+  return end;
+}
+
+double s21_strtod(const char *str, char **endptr) {
+  double value;
+  int range, tail;
+  const char *end = s21_scan_double(str, &value, &range, &tail);
+  if (endptr != s21_NULL) *endptr = (char *)end;
+  if (range) errno = ERANGE;
+  return value;
+}
+
+// Significant digits kept for long doubles. The halfway point between two
+// long doubles with a 64-bit mantissa has at most 11515 of them, so any
+// digits past these only matter as a nonzero tail.
+#define S21_PARSE_LDIGITS 11600
+
+// Decimal 0.d[0]d[1]... * 10^point, one digit value per byte, for the
+// long double conversion. The 64-bit s21_lemire tables stop at doubles, so
+// long doubles scale these digits by powers of two instead (the simple
+// decimal conversion of Wuffs and Go). At most limit digits are kept;
+// shifts write up to 19 more before they are cut.
+typedef struct {
+  int len;
+  int point;
+  int truncated;
+  int limit;
+  unsigned char d[S21_PARSE_LDIGITS + 20];
+} s21_long_decimal;
+
+static void s21_ldec_trim(s21_long_decimal *a) {
+  while (a->len > 0 && a->d[a->len - 1] == 0) a->len--;
+  if (a->len == 0) a->point = 0;
+}
+
+// Multiplies by 2^k, 0 < k <= 60, from the last digit up. The product has
+// at most 19 more digits, so it is written that far up and moved back.
+static void s21_ldec_shl(s21_long_decimal *a, int k) {
+  uint64_t n = 0;
+  int w = a->len + 19;
+  for (int r = a->len - 1; r >= 0; r--) {
+    n += (uint64_t)a->d[r] << k;
+    a->d[--w] = (unsigned char)(n % 10);
+    n /= 10;
+  }
+  for (; n > 0; n /= 10) a->d[--w] = (unsigned char)(n % 10);
+  int len = a->len + 19 - w;
+  s21_memmove(a->d, a->d + w, (s21_size_t)len);
+  a->point += len - a->len;
+  a->len = len;
+  for (; a->len > a->limit; a->len--)
+    a->truncated |= a->d[a->len - 1] != 0;
+  s21_ldec_trim(a);
+}
+
+// Divides by 2^k, 0 < k <= 60, from the first digit down.
+static void s21_ldec_shr(s21_long_decimal *a, int k) {
+  uint64_t n = 0, mask = (1ULL << k) - 1;
+  int r = 0, w = 0;
+  while (n >> k == 0) {
+    if (r >= a->len && n == 0) {
+      a->len = 0;
+      return;
+    }
+    n = n * 10 + (r < a->len ? a->d[r] : 0);
+    r++;
+  }
+  a->point -= r - 1;
+  for (; r < a->len; r++) {
+    a->d[w++] = (unsigned char)(n >> k);
+    n = (n & mask) * 10 + a->d[r];
+  }
+  for (; n > 0; n = (n & mask) * 10) {
+    if (w < a->limit)
+      a->d[w++] = (unsigned char)(n >> k);
+    else
+      a->truncated |= n >> k != 0;
+  }
+  a->len = w;
+  s21_ldec_trim(a);
+}
+
+// Multiplies by 2^k, or divides by 2^-k when k is negative.
+static void s21_ldec_shift(s21_long_decimal *a, int k) {
+  for (; k > 60; k -= 60) s21_ldec_shl(a, 60);
+  for (; k < -60; k += 60) s21_ldec_shr(a, 60);
+  if (k > 0) s21_ldec_shl(a, k);
+  if (k < 0) s21_ldec_shr(a, -k);
+}
+
+// Bits to shift by for a number with point digits before or after the
+// point, to bring it towards [1/2, 1) without passing it.
+static int s21_ldec_step(int point) {
+  static const int steps[9] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+  if (point >= 19) return 59;
+  return point >= 9 ? 27 : steps[point];
+}
+
+// Stores the long double nearest to the text in *value, halfway cases to
+// even, keeping limit digits: the digits are shifted into [1/2, 1), which
+// gives the binary exponent, then by the mantissa width, and rounded once.
+// Cut digits only lower the value, by far less than 10^-16 of the last
+// bit, so returns 0 when a cut left the rounding closer than that to a
+// halfway point.
+static int s21_ldec_convert(const s21_decimal_text *dec, int limit,
+                            long double *value) {
+  s21_long_decimal a;
+  int point = 0, exp2 = 0, n;
+  a.len = a.point = a.truncated = 0;
+  a.limit = limit;
+  for (const char *p = dec->digits; p < dec->digits_end; p++) {
+    if (*p == '.') {
+      point = 1;
+    } else if (a.len == 0 && *p == '0') {
+      a.point -= point;
+    } else {
+      a.point += !point;
+      if (a.len < limit)
+        a.d[a.len++] = (unsigned char)(*p - '0');
+      else
+        a.truncated |= *p != '0';
+    }
+  }
+  a.point += dec->exponent;
+  s21_ldec_trim(&a);
+  // Here 10^(point - 1) <= value < 10^point. Subnormals go about 20
+  // orders of magnitude below LDBL_MIN.
+  *value = a.point > LDBL_MAX_10_EXP + 1 ? HUGE_VALL : 0;
+  if (a.point > LDBL_MAX_10_EXP + 1 || a.point < LDBL_MIN_10_EXP - 30)
+    return 1;
+  while (a.point > 0) {
+    n = s21_ldec_step(a.point);
+    s21_ldec_shift(&a, -n);
+    exp2 += n;
+  }
+  while (a.point < 0 || (a.point == 0 && a.d[0] < 5)) {
+    n = s21_ldec_step(-a.point);
+    s21_ldec_shift(&a, n);
+    exp2 -= n;
+  }
+  // Now value = f * 2^exp2 with f in [1/2, 1). Below LDBL_MIN the
+  // mantissa keeps fewer bits.
+  if (exp2 < LDBL_MIN_EXP) {
+    s21_ldec_shift(&a, exp2 - LDBL_MIN_EXP);
+    exp2 = LDBL_MIN_EXP;
+  }
+  *value = HUGE_VALL;
+  if (exp2 > LDBL_MAX_EXP) return 1;
+  s21_ldec_shift(&a, S21_LDBL_BITS);
+  uint64_t mant = 0;
+  int i = 0, up = 0;
+  for (; i < a.point && i < a.len; i++) mant = mant * 10 + a.d[i];
+  for (; i < a.point; i++) mant *= 10;
+  if (a.point >= 0 && a.point < a.len)
+    up = a.d[a.point] > 5 ||
+         (a.d[a.point] == 5 &&
+          (a.point + 1 < a.len || a.truncated || (mant & 1)));
+  if (a.truncated && a.point >= 0 && a.point < a.len &&
+      (a.d[a.point] == 4 || a.d[a.point] == 5)) {
+    // Fraction 0.4999... or 0.5000... over the next 15 digits.
+    int run = 1, fill = a.d[a.point] == 4 ? 9 : 0;
+    while (run < 16 && (a.point + run < a.len ? a.d[a.point + run] : 0) == fill)
+      run++;
+    if (run == 16) return 0;
+  }
+  // Rounding up may give 2^64, which the long double still holds exactly.
+  *value = ldexpl((long double)mant + up, exp2 - S21_LDBL_BITS);
+  return 1;
+}
+
+// The long double nearest to the text, halfway cases to even. Exact small
+// cases are one operation, like for doubles; the rest take 64 digits, and
+// all of them only when that leaves the rounding open.
+static long double s21_decimal_to_long_double(const s21_decimal_text *dec) {
+  static const long double exact_pow10[28] = {
+      1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,
+      1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+      1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L};
+  // 10^k is exact while 5^k fits in the mantissa.
+  const int exact_max = S21_LDBL_BITS >= 64 ? 27 : 22;
+  long double value;
+  if (dec->w == 0) return 0;
+  if (!dec->truncated && (dec->w >> (S21_LDBL_BITS - 1)) >> 1 == 0 &&
+      dec->exp10 >= -exact_max && dec->exp10 <= exact_max) {
+    value = (long double)dec->w;
+    if (dec->exp10 < 0) return value / exact_pow10[-dec->exp10];
+    return value * exact_pow10[dec->exp10];
+  }
+  if (!s21_ldec_convert(dec, 64, &value))
+    s21_ldec_convert(dec, S21_PARSE_LDIGITS, &value);
+  return value;
+}
+
+// The long double nearest to m * 2^exp2, with the bits below m as
+// s21_float_text keeps them, halfway cases to even.
+static long double s21_make_long_double(uint64_t m, int exp2, int half,
+                                        int sticky) {
+  if (m == 0) return 0;
+  int lz = S21_CLZLL(m), shift = 64 - S21_LDBL_BITS, up;
+  m <<= lz;
+  exp2 -= lz;
+  // m * 2^exp2 = f * 2^(exp2 + 64) with f in [1/2, 1).
+  if (exp2 + 64 < LDBL_MIN_EXP) shift += LDBL_MIN_EXP - (exp2 + 64);
+  if (shift > 64) return 0;
+  uint64_t mant = shift == 64 ? 0 : m >> shift;
+  if (shift == 0) {
+    up = half && (sticky || (mant & 1));
+  } else {
+    uint64_t rem = shift == 64 ? m : m & ((1ULL << shift) - 1);
+    uint64_t halfway = 1ULL << (shift - 1);
+    up = rem > halfway ||
+         (rem == halfway && (half || sticky || (mant & 1)));
+  }
+  return ldexpl((long double)mant + up, exp2 + shift);
+}
+
+// s21_scan_double for long doubles, without *range.
+static const char *s21_scan_long_double(const char *str, long double *value,
+                                        int *tail) {
+  s21_float_text num;
+  long double res = 0;
+  const char *end = s21_scan_float_text(str, &num, tail);
+  if (end == str)
+    ;
+  else if (num.kind == S21_FLOAT_HEX)
+    res = s21_make_long_double(num.m, num.exp2, num.half, num.sticky);
+  else if (num.kind == S21_FLOAT_INF)
+    res = HUGE_VALL;
+  else if (num.kind == S21_FLOAT_NAN)
+    res = NAN;
+  else
+    res = s21_decimal_to_long_double(&num.dec);
+  *value = num.negative && end != str ? -res : res;
+  return end;
+}
+
+// SSCANF
+
+// Conversion specification of s21_sscanf.
+typedef struct {
+  int suppress;
+  s21_size_t width;
+  char length;
+  char length2;
+  char spec;
+} s21_scan_spec;
+
+// The field of width bytes at str as a string that ends where the field
+// does, so that the number parsers stop there: str itself when the input
+// ends within the width, otherwise a copy of the first width bytes in buf,
+// or in *heap from s21_malloc when they do not fit. Returns s21_NULL when
+// memory runs out.
+static const char *s21_scan_field(const char *str, s21_size_t width,
+                                  char *buf, s21_size_t size, char **heap) {
+  *heap = s21_NULL;
+  if (width == 0 || width == (s21_size_t)-1 ||
+      s21_memchr(str, '\0', width + 1) != s21_NULL)
+    return str;
+  char *field = buf;
+  if (width >= size) field = *heap = s21_malloc(width + 1);
+  if (field != s21_NULL) {
+    s21_memcpy(field, str, width);
+    field[width] = '\0';
+  }
+  return field;
+}
+
+static void s21_store_signed(va_list *ap, const s21_scan_spec *spec,
+                             long long value) {
+  if (spec->length == 'h' && spec->length2 == 'h')
+    *va_arg(*ap, signed char *) = (signed char)value;
+  else if (spec->length == 'h')
+    *va_arg(*ap, short *) = (short)value;
+  else if (spec->length == 'l' && spec->length2 == 'l')
+    *va_arg(*ap, long long *) = value;
+  else if (spec->length == 'l')
+    *va_arg(*ap, long *) = (long)value;
+  else
+    *va_arg(*ap, int *) = (int)value;
+}
+
+static void s21_store_unsigned(va_list *ap, const s21_scan_spec *spec,
+                               unsigned long long value) {
+  if (spec->length == 'h' && spec->length2 == 'h')
+    *va_arg(*ap, unsigned char *) = (unsigned char)value;
+  else if (spec->length == 'h')
+    *va_arg(*ap, unsigned short *) = (unsigned short)value;
+  else if (spec->length == 'l' && spec->length2 == 'l')
+    *va_arg(*ap, unsigned long long *) = value;
+  else if (spec->length == 'l')
+    *va_arg(*ap, unsigned long *) = (unsigned long)value;
+  else
+    *va_arg(*ap, unsigned *) = (unsigned)value;
+}
+
+// Converts an integer field, cut to its width by s21_scan_field. Returns
+// the number of bytes read, 0 when the field holds no number.
+static s21_size_t s21_scan_int_field(const char *src, va_list *ap,
+                                     const s21_scan_spec *spec) {
+  unsigned long long value;
+  int negative, overflow, base = 10;
+  if (spec->spec == 'i') base = 0;
+  if (spec->spec == 'o') base = 8;
+  if (spec->spec == 'x' || spec->spec == 'X' || spec->spec == 'p') base = 16;
+  const char *end = s21_scan_integer(src, base, &value, &negative, &overflow);
+  if (end == src) return 0;
+  // A "0x" without digits is read as zero, like glibc does.
+  const char *digits = src + (*src == '-' || *src == '+');
+  if ((base == 0 || base == 16) && end == digits + 1 && *digits == '0' &&
+      (*end | 0x20) == 'x')
+    end++;
+  // Out of range values saturate as with s21_strtoll and s21_strtoull.
+  int is_signed = spec->spec == 'd' || spec->spec == 'i';
+  if (is_signed && value > (unsigned long long)LLONG_MAX + negative)
+    overflow = 1;
+  if (overflow)
+    value = !is_signed ? ULLONG_MAX
+            : negative ? (unsigned long long)LLONG_MIN
+                       : (unsigned long long)LLONG_MAX;
+  else if (negative)
+    value = 0 - value;
+  if (spec->suppress) {
+    // Nothing to store.
+  } else if (spec->spec == 'p') {
+    *va_arg(*ap, void **) = (void *)(uintptr_t)value;
+  } else if (is_signed) {
+    s21_store_signed(ap, spec, (long long)value);
+  } else {
+    s21_store_unsigned(ap, spec, value);
+  }
+  return (s21_size_t)(end - src);
+}
+
+// Converts a floating point field, like s21_scan_int_field.
+static s21_size_t s21_scan_float_field(const char *src, va_list *ap,
+                                       const s21_scan_spec *spec) {
+  double value = 0;
+  long double long_value = 0;
+  int range, tail;
+  const char *end = spec->length == 'L'
+                        ? s21_scan_long_double(src, &long_value, &tail)
+                        : s21_scan_double(src, &value, &range, &tail);
+  // Like glibc, an exponent without digits is read and ignored.
+  if (end == src || tail < 0) return 0;
+  end += tail;
+  if (spec->suppress)
+    ;
+  else if (spec->length == 'L')
+    *va_arg(*ap, long double *) = long_value;
+  else if (spec->length == 'l')
+    *va_arg(*ap, double *) = value;
+  else
+    *va_arg(*ap, float *) = (float)value;
+  return (s21_size_t)(end - src);
+}
+
+// Parses the set of a %[ conversion at format, after the '['. Returns the
+// position after the closing ']', or s21_NULL if there is none.
+static const char *s21_scan_set(const char *format, s21_byteset *set) {
+  int negate = *format == '^';
+  if (negate) format++;
+  s21_byteset_init(set, "", 0);
+  // A ']' right after the opening bracket belongs to the set.
+  if (*format == ']') s21_byteset_add(set, (unsigned char)*format++);
+  while (*format != ']') {
+    if (*format == '\0') return s21_NULL;
+    unsigned char lo = (unsigned char)*format++;
+    if (*format == '-' && format[1] != ']' && format[1] != '\0' &&
+        (unsigned char)format[1] >= lo) {
+      unsigned char hi = (unsigned char)format[1];
+      for (unsigned c = lo; c <= hi; c++) s21_byteset_add(set, c);
+      format += 2;
+    } else {
+      s21_byteset_add(set, lo);
+    }
+  }
+  if (negate) {
+    for (int k = 0; k < 4; k++) set->bits[k] = ~set->bits[k];
+  }
+  return format + 1;
+}
+
+// Reads %s, %c and %[ fields. Returns the number of bytes read.
+static s21_size_t s21_scan_chars(const char *str, va_list *ap,
+                                 const s21_scan_spec *spec,
+                                 const s21_byteset *set) {
+  s21_size_t n = 0, width = spec->width;
+  if (spec->spec == 'c') {
+    if (width == 0) width = 1;
+    while (n < width && str[n] != '\0') n++;
+  } else {
+    while ((width == 0 || n < width) && str[n] != '\0' &&
+           (spec->spec == 's' ? !s21_is_space(str[n])
+                              : S21_BYTESET_HAS(set, str[n])))
+      n++;
+  }
+  if (n > 0 && !spec->suppress) {
+    char *dest = va_arg(*ap, char *);
+    s21_memcpy(dest, str, n);
+    if (spec->spec != 'c') dest[n] = '\0';
+  }
+  return n;
+}
+
+int s21_sscanf(const char *str, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vsscanf(str, format, ap);
+  va_end(ap);
+  return res;
+}
+
+int s21_vsscanf(const char *str, const char *format, va_list args) {
+  const char *s = str;
+  int assigned = 0, done = 0;
+  va_list ap;
+  va_copy(ap, args);
+  while (*format != '\0' && !done) {
+    if (s21_is_space(*format)) {
+      while (s21_is_space(*format)) format++;
+      while (s21_is_space(*s)) s++;
+      continue;
+    }
+    if (*format != '%' || format[1] == '%') {
+      if (*format == '%') {
+        format++;
+        while (s21_is_space(*s)) s++;
+      }
+      if (*s == '\0') {
+        done = -1;
+      } else if (*s != *format) {
+        done = 1;
+      } else {
+        s++;
+        format++;
+      }
+      continue;
+    }
+    s21_scan_spec spec = {0, 0, '\0', '\0', '\0'};
+    s21_byteset set;
+    format++;
+    if (*format == '*') {
+      spec.suppress = 1;
+      format++;
+    }
+    while (isdigit((unsigned char)*format))
+      spec.width = spec.width * 10 + (s21_size_t)(*format++ - '0');
+    if (*format == 'h' || *format == 'l' || *format == 'L') {
+      spec.length = *format++;
+      if (*format == spec.length && spec.length != 'L')
+        spec.length2 = *format++;
+    }
+    spec.spec = *format++;
+    if (spec.spec == '[' && (format = s21_scan_set(format, &set)) == s21_NULL)
+      break;
+    if (spec.spec == 'n') {
+      if (!spec.suppress) s21_store_signed(&ap, &spec, (long long)(s - str));
+      continue;
+    }
+    if (spec.spec != 'c' && spec.spec != '[')
+      while (s21_is_space(*s)) s++;
+    if (*s == '\0') {
+      done = -1;
+      break;
+    }
+    s21_size_t n = 0;
+    int is_int = spec.spec != '\0' && s21_strchr("diouxXp", spec.spec);
+    int is_float = spec.spec != '\0' && s21_strchr("aAeEfFgG", spec.spec);
+    if (is_int || is_float) {
+      char buf[512], *heap;
+      const char *src = s21_scan_field(s, spec.width, buf, sizeof(buf), &heap);
+      if (src != s21_NULL && is_int)
+        n = s21_scan_int_field(src, &ap, &spec);
+      else if (src != s21_NULL)
+        n = s21_scan_float_field(src, &ap, &spec);
+      s21_free(heap);
+    } else if (spec.spec == 's' || spec.spec == 'c' || spec.spec == '[') {
+      n = s21_scan_chars(s, &ap, &spec, &set);
+    }
+    if (n == 0) {
+      done = 1;
+    } else {
+      s += n;
+      if (!spec.suppress) assigned++;
+    }
+  }
+  va_end(ap);
+  return done == -1 && assigned == 0 ? EOF : assigned;
+}
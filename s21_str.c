@@ -0,0 +1,189 @@
+#include <stdlib.h>
+
+#include "s21_simd.h"
+#include "s21_string.h"
+
+// LENGTH-CARRYING STRINGS
+
+// Top bit of s21_str.len, set while the characters are on the heap.
+#define S21_STR_HEAP ((s21_size_t)1 << (sizeof(s21_size_t) * CHAR_BIT - 1))
+
+static char *s21_str_chars(s21_str *s) {
+  return s->len & S21_STR_HEAP ? s->data.heap.ptr : s->data.buf;
+}
+
+static void s21_str_set_len(s21_str *s, s21_size_t len) {
+  s->len = (s->len & S21_STR_HEAP) | len;
+  s21_str_chars(s)[len] = '\0';
+}
+
+void s21_str_init(s21_str *s) {
+  s->len = 0;
+  s->data.buf[0] = '\0';
+}
+
+int s21_str_from(s21_str *s, const char *cstr) {
+  s21_str_init(s);
+  return cstr != s21_NULL ? s21_str_assign(s, cstr, s21_strlen(cstr)) : 0;
+}
+
+void s21_str_free(s21_str *s) {
+  if (s->len & S21_STR_HEAP) s21_free(s->data.heap.ptr);
+  s21_str_init(s);
+}
+
+s21_size_t s21_str_len(const s21_str *s) { return s->len & ~S21_STR_HEAP; }
+
+s21_size_t s21_str_cap(const s21_str *s) {
+  return s->len & S21_STR_HEAP ? s->data.heap.cap : S21_STR_INLINE;
+}
+
+const char *s21_str_cstr(const s21_str *s) {
+  return s->len & S21_STR_HEAP ? s->data.heap.ptr : s->data.buf;
+}
+
+char *s21_str_data(s21_str *s) { return s21_str_chars(s); }
+
+// Capacity grows by half or more, so n appends cost O(n) copying in all.
+int s21_str_reserve(s21_str *s, s21_size_t cap) {
+  s21_size_t old_cap = s21_str_cap(s), len = s21_str_len(s);
+  char *ptr = s21_NULL;
+  if (cap <= old_cap) return 0;
+  if (cap >= S21_STR_HEAP - 1) return -1;
+  if (cap < old_cap + old_cap / 2) cap = old_cap + old_cap / 2;
+  if (s->len & S21_STR_HEAP) {
+    ptr = s21_realloc(s->data.heap.ptr, cap + 1);
+  } else {
+    ptr = s21_malloc(cap + 1);
+    if (ptr != s21_NULL) s21_memcpy(ptr, s->data.buf, len + 1);
+  }
+  if (ptr == s21_NULL) return -1;
+  s->data.heap.ptr = ptr;
+  s->data.heap.cap = cap;
+  s->len = len | S21_STR_HEAP;
+  return 0;
+}
+
+int s21_str_assign(s21_str *s, const char *data, s21_size_t n) {
+  int res = -1;
+  if (data != s21_NULL && s21_str_reserve(s, n) == 0) {
+    s21_memmove(s21_str_chars(s), data, n);
+    s21_str_set_len(s, n);
+    res = 0;
+  }
+  return res;
+}
+
+int s21_str_append(s21_str *s, const char *data, s21_size_t n) {
+  s21_size_t len = s21_str_len(s);
+  int res = -1;
+  if (data != s21_NULL && n <= S21_STR_HEAP - 2 - len) {
+    // data may point into s, so its offset has to outlive the realloc.
+    uintptr_t offset = (uintptr_t)data - (uintptr_t)s21_str_chars(s);
+    int inside = offset <= len;
+    if (s21_str_reserve(s, len + n) == 0) {
+      char *chars = s21_str_chars(s);
+      s21_memcpy(chars + len, inside ? chars + offset : data, n);
+      s21_str_set_len(s, len + n);
+      res = 0;
+    }
+  }
+  return res;
+}
+
+int s21_str_cat(s21_str *dest, const s21_str *src) {
+  return s21_str_append(dest, s21_str_cstr(src), s21_str_len(src));
+}
+
+int s21_str_cat_cstr(s21_str *dest, const char *src) {
+  return src != s21_NULL ? s21_str_append(dest, src, s21_strlen(src)) : -1;
+}
+
+int s21_str_cmp(const s21_str *s1, const s21_str *s2) {
+  s21_size_t len1 = s21_str_len(s1), len2 = s21_str_len(s2);
+  int res = s21_memcmp(s21_str_cstr(s1), s21_str_cstr(s2),
+                       len1 < len2 ? len1 : len2);
+  if (res == 0) res = len1 < len2 ? -1 : len1 > len2;
+  return res;
+}
+
+int s21_str_eq(const s21_str *s1, const s21_str *s2) {
+  s21_size_t len = s21_str_len(s1);
+  return len == s21_str_len(s2) &&
+         s21_memeq(s21_str_cstr(s1), s21_str_cstr(s2), len);
+}
+
+s21_size_t s21_str_find(const s21_str *s, const s21_str *needle,
+                        s21_size_t from) {
+  s21_size_t len = s21_str_len(s), res = S21_STR_NPOS;
+  if (from <= len) {
+    const unsigned char *hay = (const unsigned char *)s21_str_cstr(s);
+    const unsigned char *found =
+        s21_find(hay + from, len - from,
+                 (const unsigned char *)s21_str_cstr(needle),
+                 s21_str_len(needle));
+    if (found != s21_NULL) res = (s21_size_t)(found - hay);
+  }
+  return res;
+}
+
+void s21_str_to_upper(s21_str *s) {
+  char *chars = s21_str_chars(s);
+  s21_size_t len = s21_str_len(s);
+  for (s21_size_t i = 0; i < len; i++) {
+    if (chars[i] >= 'a' && chars[i] <= 'z') chars[i] = (char)(chars[i] - 32);
+  }
+}
+
+void s21_str_to_lower(s21_str *s) {
+  char *chars = s21_str_chars(s);
+  s21_size_t len = s21_str_len(s);
+  for (s21_size_t i = 0; i < len; i++) {
+    if (chars[i] >= 'A' && chars[i] <= 'Z') chars[i] = (char)(chars[i] + 32);
+  }
+}
+
+static void s21_reverse_bytes(char *p, s21_size_t n) {
+  for (s21_size_t i = 0; i < n / 2; i++) {
+    char tmp = p[i];
+    p[i] = p[n - 1 - i];
+    p[n - 1 - i] = tmp;
+  }
+}
+
+int s21_str_insert(s21_str *s, s21_size_t index, const char *data,
+                   s21_size_t n) {
+  s21_size_t len = s21_str_len(s);
+  int res = -1;
+  if (index <= len && s21_str_append(s, data, n) == 0) {
+    // The appended copy is rotated into place with three reversals, which
+    // needs no buffer and also covers data pointing into s.
+    char *chars = s21_str_chars(s) + index;
+    if (index < len) {
+      s21_reverse_bytes(chars, len - index);
+      s21_reverse_bytes(chars + len - index, n);
+      s21_reverse_bytes(chars, len - index + n);
+    }
+    res = 0;
+  }
+  return res;
+}
+
+int s21_str_insert_cstr(s21_str *s, s21_size_t index, const char *str) {
+  return str != s21_NULL ? s21_str_insert(s, index, str, s21_strlen(str))
+                         : -1;
+}
+
+void s21_str_trim(s21_str *s, const char *trim_chars) {
+  s21_byteset set;
+  char *chars = s21_str_chars(s);
+  s21_size_t len = s21_str_len(s);
+  if (trim_chars == s21_NULL || *trim_chars == '\0')
+    trim_chars = "\t\n\v\r\f ";
+  s21_byteset_init(&set, trim_chars, 0);
+  s21_size_t start =
+      s21_span_n_kernel((const unsigned char *)chars, len, &set, 1);
+  while (len > start && S21_BYTESET_HAS(&set, chars[len - 1])) len--;
+  s21_memmove(chars, chars + start, len - start);
+  s21_str_set_len(s, len - start);
+}
@@ -1,20 +1,19 @@
 #include "s21_string.h"
 
 #include <ctype.h>
+#include <errno.h>
 #include <limits.h>
 #include <math.h>
 #include <stdarg.h>
 #include <stdlib.h>
 
+#include "s21_simd.h"
+
 // COPY FUNCTIONS
 
 void *s21_memcpy(void *dest, const void *src, s21_size_t n) {
-  char *tmp_dest = (char *)dest;
-  const char *tmp_src = (const char *)src;
-  if ((tmp_dest != s21_NULL) && (tmp_src != s21_NULL)) {
-    while (n--) {
-      *(tmp_dest++) = *(tmp_src++);
-    }
+  if ((dest != s21_NULL) && (src != s21_NULL)) {
+    s21_copy_kernel((char *)dest, (const char *)src, n);
   }
   return dest;
 }
@@ -22,14 +21,15 @@ void *s21_memcpy(void *dest, const void *src, s21_size_t n) {
 void *s21_memmove(void *dest, const void *src, s21_size_t n) {
   char *tmp_dest = (char *)dest;
   const char *tmp_src = (const char *)src;
-  char *buf = (char *)malloc(sizeof(char) * n);
-  for (unsigned int i = 0; i < n; i++) {
-    buf[i] = tmp_src[i];
-  }
-  for (unsigned int i = 0; i < n; i++) {
-    tmp_dest[i] = buf[i];
+  if ((tmp_dest != s21_NULL) && (tmp_src != s21_NULL) &&
+      (tmp_dest != tmp_src)) {
+    // dest below src wraps around, so only dest inside src copies backward
+    if ((uintptr_t)tmp_dest - (uintptr_t)tmp_src >= n) {
+      s21_copy_kernel(tmp_dest, tmp_src, n);
+    } else {
+      s21_copy_back_kernel(tmp_dest, tmp_src, n);
+    }
   }
-  free(buf);
   return dest;
 }
 
@@ -64,40 +64,50 @@ char *s21_strncpy(char *dest, const char *src, s21_size_t n) {
 
 char *s21_strcat(char *dest, const char *src) {
   s21_size_t len_dest = s21_strlen(dest);
-  s21_size_t len_src = s21_strlen(src);
-  s21_size_t i = 0 + len_dest;
-  for (; i < len_src + len_dest; i++) {
-    (*(dest + i)) = (*(src + i - len_dest));
-  }
-  (*(dest + i)) = '\0';
+  s21_memcpy(dest + len_dest, src, s21_strlen(src) + 1);
   return dest;
 }
 
 char *s21_strncat(char *dest, const char *src, s21_size_t n) {
   s21_size_t len = s21_strlen(dest);
-  s21_size_t i = 0 + len;
-  for (; i < s21_strlen(src) + len && i - len < n; i++) {
-    (*(dest + i)) = (*(src + i - len));
-  }
-  (*(dest + i)) = '\0';
+  s21_size_t i = 0;
+  for (; i < n && src[i] != '\0'; i++) dest[len + i] = src[i];
+  dest[len + i] = '\0';
   return dest;
 }
 
 // COMPAIRSON FUNCTIONS
 
 int s21_memcmp(const void *str1, const void *str2, s21_size_t n) {
-  int result = 0;
-  s21_size_t i = 0;
-  int diff = 0;
-  for (; i < n && diff == 0; i++) {
-    diff = (*((char *)str1 + i) - *((char *)str2 + i));
-    if (n - i - 1 == 0) {
-      result += diff;
-    } else {
-      result += (diff)*pow(sizeof(*(str1 + i)), (n - i - 1));
-    }
+  return s21_memcmp_kernel((const unsigned char *)str1,
+                           (const unsigned char *)str2, n);
+}
+
+int s21_memeq(const void *str1, const void *str2, s21_size_t n) {
+  const unsigned char *a = (const unsigned char *)str1;
+  const unsigned char *b = (const unsigned char *)str2;
+  uint64_t diff = 0;
+  // Keys of up to 32 bytes are compared with two overlapping loads per
+  // size class and no loop or branch on the data.
+  if (n == 0) {
+    diff = 0;
+  } else if (n < 4) {
+    diff = (a[0] ^ b[0]) | (a[n / 2] ^ b[n / 2]) | (a[n - 1] ^ b[n - 1]);
+  } else if (n < 8) {
+    diff = (S21_LOAD32(a) ^ S21_LOAD32(b)) |
+           (S21_LOAD32(a + n - 4) ^ S21_LOAD32(b + n - 4));
+  } else if (n <= 16) {
+    diff = (S21_LOAD64(a) ^ S21_LOAD64(b)) |
+           (S21_LOAD64(a + n - 8) ^ S21_LOAD64(b + n - 8));
+  } else if (n <= 32) {
+    diff = (S21_LOAD64(a) ^ S21_LOAD64(b)) |
+           (S21_LOAD64(a + 8) ^ S21_LOAD64(b + 8)) |
+           (S21_LOAD64(a + n - 16) ^ S21_LOAD64(b + n - 16)) |
+           (S21_LOAD64(a + n - 8) ^ S21_LOAD64(b + n - 8));
+  } else {
+    diff = s21_memcmp_kernel(a, b, n) != 0;
   }
-  return result;
+  return diff == 0;
 }
 
 int s21_strcmp(const char *str1, const char *str2) {
@@ -125,17 +135,41 @@ int s21_strncmp(const char *str1, const char *str2, s21_size_t n) {
 // SEARCH FUNCTIONS
 
 void *s21_memchr(const void *str, int c, s21_size_t n) {
-  unsigned char *p = (unsigned char *)str;
-  unsigned char *finded_char = s21_NULL;
-  while ((str != s21_NULL) && (n--)) {
-    if (*p != (unsigned char)c) {
-      p++;
-    } else {
-      finded_char = p;
-      break;
-    }
+  const unsigned char *finded_char = s21_NULL;
+  if (str != s21_NULL) {
+    finded_char = s21_memchr_kernel((const unsigned char *)str,
+                                    (unsigned char)c, n);
+  }
+  return (void *)finded_char;
+}
+
+void *s21_memrchr(const void *str, int c, s21_size_t n) {
+  const unsigned char *finded_char = s21_NULL;
+  if (str != s21_NULL) {
+    finded_char = s21_memrchr_kernel((const unsigned char *)str,
+                                     (unsigned char)c, n);
   }
-  return finded_char;
+  return (void *)finded_char;
+}
+
+void *s21_memchr2(const void *str, int c1, int c2, s21_size_t n) {
+  const unsigned char *finded_char = s21_NULL;
+  if (str != s21_NULL) {
+    finded_char =
+        s21_memchr3_kernel((const unsigned char *)str, (unsigned char)c1,
+                           (unsigned char)c2, (unsigned char)c2, n);
+  }
+  return (void *)finded_char;
+}
+
+void *s21_memchr3(const void *str, int c1, int c2, int c3, s21_size_t n) {
+  const unsigned char *finded_char = s21_NULL;
+  if (str != s21_NULL) {
+    finded_char =
+        s21_memchr3_kernel((const unsigned char *)str, (unsigned char)c1,
+                           (unsigned char)c2, (unsigned char)c3, n);
+  }
+  return (void *)finded_char;
 }
 
 char *s21_strchr(const char *str, int c) {
@@ -155,40 +189,21 @@ char *s21_strchr(const char *str, int c) {
 
 s21_size_t s21_strcspn(const char *str1, const char *str2) {
   s21_size_t len = 0;
-  int flag = 0;
-  if (str1 != s21_NULL || str2 != s21_NULL) {
-    for (const char *i = str1; *i != '\0'; i++) {
-      for (const char *j = str2; *j != '\0'; j++) {
-        if (*i == *j) {
-          flag = 1;
-          break;
-        }
-      }
-      if (flag) {
-        break;
-      }
-      len++;
-    }
+  s21_byteset set;
+  if (str1 != s21_NULL && str2 != s21_NULL) {
+    s21_byteset_init(&set, str2, 1);
+    len = s21_span_kernel((const unsigned char *)str1, &set, 0);
   }
   return len;
 }
 
 char *s21_strpbrk(const char *str1, const char *str2) {
   char *c = s21_NULL;
-  int flag = 0;
-  if (str1 != s21_NULL || str2 != s21_NULL) {
-    for (const char *i = str1; *i != '\0'; i++) {
-      for (const char *j = str2; *j != '\0'; j++) {
-        if (*i == *j) {
-          c = (char *)i;
-          flag = 1;
-          break;
-        }
-      }
-      if (flag) {
-        break;
-      }
-    }
+  s21_byteset set;
+  if (str1 != s21_NULL && str2 != s21_NULL) {
+    s21_byteset_init(&set, str2, 1);
+    c = (char *)str1 + s21_span_kernel((const unsigned char *)str1, &set, 0);
+    if (*c == '\0') c = s21_NULL;
   }
   return c;
 }
@@ -208,212 +223,498 @@ char *s21_strrchr(const char *str, int c) {
 
 s21_size_t s21_strspn(const char *str1, const char *str2) {
   s21_size_t len = 0;
-  int flag = 0;
-  if (str1 != s21_NULL || str2 != s21_NULL) {
-    for (const char *i = str1; *i != '\0'; i++) {
-      for (const char *j = str2; *j != '\0'; j++) {
-        if (*i == *j) {
-          len++;
-          flag = 1;
-          break;
-        }
-      }
-      if (flag == 0) {
-        break;
+  s21_byteset set;
+  if (str1 != s21_NULL && str2 != s21_NULL) {
+    s21_byteset_init(&set, str2, 0);
+    len = s21_span_kernel((const unsigned char *)str1, &set, 1);
+  }
+  return len;
+}
+
+// Two-Way string matching (Crochemore and Perrin). The needle is split at
+// a critical factorization u.v; v is matched left to right, then u right
+// to left, and a mismatch shifts by the period of the needle or past the
+// mismatch. Search time is linear and the state is a few words, whatever
+// the length of the needle.
+typedef struct {
+  const unsigned char *needle;
+  s21_size_t len, crit, period;
+  int periodic;
+} s21_twoway;
+
+// Start of the maximal suffix of x[0..m) for the order chosen by reverse,
+// minus one, with its period stored in *period.
+static s21_size_t s21_max_suffix(const unsigned char *x, s21_size_t m,
+                                 s21_size_t *period, int reverse) {
+  s21_size_t ms = (s21_size_t)-1, j = 0, k = 1, p = 1;
+  while (j + k < m) {
+    unsigned char a = x[j + k], b = x[ms + k];
+    if (a == b) {
+      if (k == p) {
+        j += p;
+        k = 1;
+      } else {
+        k++;
       }
-      flag = 0;
+    } else if (reverse ? a > b : a < b) {
+      j += k;
+      k = 1;
+      p = j - ms;
+    } else {
+      ms = j++;
+      k = p = 1;
     }
   }
-  return len;
+  *period = p;
+  return ms;
 }
 
-char *s21_strstr(const char *haystack, const char *needle) {
-  char *answer = s21_NULL;
-  int pi[2048] = {'\0'};
+static void s21_twoway_init(s21_twoway *tw, const unsigned char *needle,
+                            s21_size_t m) {
+  s21_size_t p1, p2, ms;
+  s21_size_t ms1 = s21_max_suffix(needle, m, &p1, 0);
+  s21_size_t ms2 = s21_max_suffix(needle, m, &p2, 1);
+  ms = ms2 + 1 > ms1 + 1 ? ms2 : ms1;
+  tw->needle = needle;
+  tw->len = m;
+  tw->crit = ms + 1;
+  tw->period = ms2 + 1 > ms1 + 1 ? p2 : p1;
+  tw->periodic = s21_memeq(needle, needle + tw->period, tw->crit);
+  if (!tw->periodic) {
+    s21_size_t right = m - tw->crit;
+    tw->period = (tw->crit > right ? tw->crit : right) + 1;
+  }
+}
 
-  if (needle && haystack) {
-    s21_size_t k, i, len = s21_strlen(needle);
-    pi[0] = 0;
-    for (i = 1; i < len; ++i) {
-      int j = pi[i - 1];
-      while ((j > 0) && (needle[i] != needle[j])) j = pi[j - 1];
-      if (needle[i] == needle[j]) ++j;
-      pi[i] = j;
+static const unsigned char *s21_twoway_find(const s21_twoway *tw,
+                                            const unsigned char *hay,
+                                            s21_size_t n) {
+  const unsigned char *x = tw->needle;
+  s21_size_t m = tw->len, crit = tw->crit, mem = 0, j = 0;
+  while (m <= n && j <= n - m) {
+    s21_size_t i = crit > mem ? crit : mem;
+    while (i < m && x[i] == hay[j + i]) i++;
+    if (i < m) {
+      j += i - crit + 1;
+      mem = 0;
+    } else {
+      i = crit;
+      while (i > mem && x[i - 1] == hay[j + i - 1]) i--;
+      if (i <= mem) return hay + j;
+      j += tw->period;
+      mem = tw->periodic ? m - tw->period : 0;
     }
+  }
+  return s21_NULL;
+}
 
-    for (k = 0, i = 0; haystack[k] && !answer; k++) {
-      while ((i > 0) && (needle[i] != haystack[k])) i = pi[i];
-      if (needle[i] == haystack[k]) ++i;
-      if (i == len) {
-        answer = (char *)haystack + k - len + 1;
-      }
+// Candidates checked per byte of haystack passed before a search gives up
+// on its filter and hands the rest of the haystack to Two-Way.
+#define S21_SEARCH_BUDGET(pos) (8 * (pos) + 1024)
+
+// Search for a needle of two or more bytes in a buffer of known length.
+// Candidates where needle bytes i1 < i2 line up come from the pair kernel
+// and are checked with s21_memeq. Once checking exceeds the budget (a
+// needle like "aaa...ab" in "aaa...a"), the rest of the haystack goes to
+// Two-Way, so the worst case stays linear. tw may be NULL, in which case
+// the factorization is only computed when needed.
+static const unsigned char *s21_pair_find(const unsigned char *hay,
+                                          s21_size_t n,
+                                          const unsigned char *needle,
+                                          s21_size_t m, s21_size_t i1,
+                                          s21_size_t i2, const s21_twoway *tw) {
+  const unsigned char *found = s21_NULL;
+  s21_size_t pos = 0, work = 0;
+  s21_twoway local;
+  while (found == s21_NULL && pos <= n - m && work <= S21_SEARCH_BUDGET(pos)) {
+    const unsigned char *p = s21_pair_kernel(hay + pos + i1, needle[i1],
+                                             needle[i2], i2 - i1,
+                                             n - m + 1 - pos);
+    if (p == s21_NULL) break;
+    p -= i1;
+    if (s21_memeq(p, needle, m)) found = p;
+    pos = (s21_size_t)(p - hay) + 1;
+    work += m;
+  }
+  if (found == s21_NULL && pos <= n - m && work > S21_SEARCH_BUDGET(pos)) {
+    if (tw == s21_NULL) {
+      s21_twoway_init(&local, needle, m);
+      tw = &local;
     }
-    if (!s21_strcmp(needle, "")) answer = (char *)haystack;
+    found = s21_twoway_find(tw, hay + pos, n - pos);
   }
-  return answer;
+  return found;
 }
 
-char *s21_strtok(char *str, const char *delim) {
-  static char *answer, *ptr;
-  s21_size_t i, len = s21_strlen(delim);
-  int k;
+const unsigned char *s21_find(const unsigned char *hay, s21_size_t n,
+                              const unsigned char *needle, s21_size_t m) {
+  const unsigned char *found = s21_NULL;
+  if (m == 0) {
+    found = hay;
+  } else if (m == 1) {
+    found = s21_memchr_kernel(hay, needle[0], n);
+  } else if (m <= n) {
+    found = s21_pair_find(hay, n, needle, m, 0, m - 1, s21_NULL);
+  }
+  return found;
+}
 
-  if (str) {
-    answer = s21_NULL;
-  } else if (ptr) {
-    answer = s21_NULL;
-    str = ptr;
-  } else if (ptr == s21_NULL) {
-    answer = s21_NULL;
-  }
+// Bytes of haystack that s21_strstr checks for the terminator before it
+// searches them: few at first, so that an early match costs little, then
+// doubling up to a block that stays in L2 for the search that follows.
+#define S21_STRSTR_FIRST 256
+#define S21_STRSTR_BLOCK 65536
 
-  if (str) {
-    for (i = 0; !answer && str[i]; i++) {
-      for (k = 0; k < (int)len && delim[k]; k++) {
-        if (delim[k] == str[i]) {
-          k = -1;
-          break;
+char *s21_strstr(const char *haystack, const char *needle) {
+  const unsigned char *found = s21_NULL;
+  if (needle && haystack) {
+    const unsigned char *hay = (const unsigned char *)haystack, *nul;
+    s21_size_t m = s21_strlen(needle), pos = 0, len = 0;
+    s21_size_t block = S21_STRSTR_FIRST;
+    // Each pass searches from pos, the first position not yet ruled out,
+    // to the end of the text known so far.
+    do {
+      nul = s21_memchr_kernel(hay + len, '\0', block);
+      len = nul != s21_NULL ? (s21_size_t)(nul - hay) : len + block;
+      found = s21_find(hay + pos, len - pos, (const unsigned char *)needle, m);
+      if (len - pos >= m) pos = len - m + 1;
+      if (block < S21_STRSTR_BLOCK) block *= 2;
+    } while (found == s21_NULL && nul == s21_NULL);
+  }
+  return (char *)found;
+}
+
+enum { S21_FIND_EMPTY, S21_FIND_BYTE, S21_FIND_PAIR };
+
+struct s21_searcher {
+  int kind;
+  s21_size_t rare1, rare2;
+  s21_twoway tw;
+  unsigned char needle[];
+};
+
+// Guess of how often byte c occurs in text, higher is more common. Lower
+// case letters follow English letter frequency.
+static int s21_byte_rank(unsigned char c) {
+  static const char letters[] = "zqjxkvbpygfwmucldrhsnioate";
+  const char *letter = s21_NULL;
+  int rank = 0;
+  if (c >= 'a' && c <= 'z') letter = s21_memchr(letters, c, 26);
+  if (letter != s21_NULL) {
+    rank = 100 + (int)(letter - letters) * 6;
+  } else if (c == ' ') {
+    rank = 255;
+  } else if (c >= 'A' && c <= 'Z') {
+    rank = 80;
+  } else if (c >= '0' && c <= '9') {
+    rank = 90;
+  } else if (c == '\n' || c == '\t' || c == ',' || c == '.') {
+    rank = 70;
+  } else if (c >= 0x21 && c < 0x7f) {
+    rank = 40;
+  } else if (c == 0) {
+    rank = 20;
+  }
+  return rank;
+}
+
+s21_searcher_t *s21_searcher_compile(const char *needle) {
+  s21_searcher_t *s = s21_NULL;
+  if (needle != s21_NULL) {
+    s21_size_t m = s21_strlen(needle);
+    s = s21_malloc(sizeof(*s) + m + 1);
+    if (s != s21_NULL) {
+      s21_memcpy(s->needle, needle, m + 1);
+      s21_twoway_init(&s->tw, s->needle, m);
+      s->kind = m == 0   ? S21_FIND_EMPTY
+                : m == 1 ? S21_FIND_BYTE
+                         : S21_FIND_PAIR;
+      // The two rarest bytes of the needle filter far more positions than
+      // its first and last byte, so the filter runs near memchr speed.
+      s->rare1 = 0;
+      s->rare2 = m > 1 ? m - 1 : 0;
+      for (s21_size_t i = 0; i < m; i++) {
+        int rank = s21_byte_rank(s->needle[i]);
+        if (rank < s21_byte_rank(s->needle[s->rare1])) {
+          s->rare2 = s->rare1;
+          s->rare1 = i;
+        } else if (i != s->rare1 &&
+                   rank < s21_byte_rank(s->needle[s->rare2])) {
+          s->rare2 = i;
         }
       }
-      if (k != -1) {
-        answer = str + i;
+      if (s->rare1 > s->rare2) {
+        s21_size_t tmp = s->rare1;
+        s->rare1 = s->rare2;
+        s->rare2 = tmp;
       }
     }
   }
+  return s;
+}
 
-  if (answer) {
-    for (ptr = answer; *ptr; ptr++) {
-      for (k = 0; k < (int)len && delim[k]; k++) {
-        if (delim[k] == *ptr) {
-          k = -1;
-          break;
-        }
-      }
-      if (k == -1) {
-        *ptr = 0;
-        ++ptr;
-        break;
-      }
+char *s21_searcher_find(const s21_searcher_t *searcher, const char *haystack,
+                        s21_size_t len) {
+  const unsigned char *found = s21_NULL;
+  const unsigned char *hay = (const unsigned char *)haystack;
+  if (searcher != s21_NULL && haystack != s21_NULL) {
+    s21_size_t m = searcher->tw.len;
+    if (searcher->kind == S21_FIND_EMPTY) {
+      found = hay;
+    } else if (searcher->kind == S21_FIND_BYTE) {
+      found = s21_memchr_kernel(hay, searcher->needle[0], len);
+    } else if (m <= len) {
+      found = s21_pair_find(hay, len, searcher->needle, m, searcher->rare1,
+                            searcher->rare2, &searcher->tw);
+    }
+  }
+  return (char *)found;
+}
+
+const char *s21_searcher_algorithm(const s21_searcher_t *searcher) {
+  static const char *const names[] = {"empty", "memchr", "pair"};
+  return searcher != s21_NULL ? names[searcher->kind] : "none";
+}
+
+void s21_searcher_free(s21_searcher_t *searcher) { s21_free(searcher); }
+
+char *s21_strtok(char *str, const char *delim) {
+  static char *next;
+  return s21_strtok_r(str, delim, &next);
+}
+
+char *s21_strtok_r(char *str, const char *delim, char **saveptr) {
+  char *token = s21_NULL;
+  s21_byteset set;
+  if (str == s21_NULL && saveptr != s21_NULL) str = *saveptr;
+  if (str != s21_NULL && delim != s21_NULL) {
+    s21_byteset_init(&set, delim, 0);
+    str += s21_span_kernel((const unsigned char *)str, &set, 1);
+    if (*str) {
+      token = str;
+      s21_byteset_add(&set, '\0');
+      str += s21_span_kernel((const unsigned char *)str, &set, 0);
+      if (*str) *str++ = '\0';
     }
-    if (!*ptr) {
-      ptr = s21_NULL;
+    *saveptr = str;
+  }
+  return token;
+}
+
+void s21_tokenizer_init(s21_tokenizer_t *tok, const char *str, s21_size_t len,
+                        const char *delim) {
+  if (tok != s21_NULL) {
+    tok->pos = str;
+    tok->end = str != s21_NULL ? str + len : str;
+    s21_byteset_init(&tok->delims, delim != s21_NULL ? delim : "", 0);
+  }
+}
+
+int s21_tokenizer_next(s21_tokenizer_t *tok, s21_span_t *token) {
+  int found = 0;
+  if (tok != s21_NULL && token != s21_NULL && tok->pos != tok->end) {
+    const unsigned char *pos = (const unsigned char *)tok->pos;
+    s21_size_t rest = (s21_size_t)(tok->end - tok->pos);
+    s21_size_t skip = s21_span_n_kernel(pos, rest, &tok->delims, 1);
+    if (skip < rest) {
+      token->ptr = tok->pos + skip;
+      token->len =
+          s21_span_n_kernel(pos + skip, rest - skip, &tok->delims, 0);
+      found = 1;
     }
+    tok->pos = found ? token->ptr + token->len : tok->end;
   }
-  return answer;
+  return found;
+}
+
+s21_size_t s21_split(const char *str, s21_size_t len, const char *delim,
+                     s21_span_t *spans, s21_size_t max) {
+  s21_size_t count = 0;
+  s21_byteset set;
+  if (str != s21_NULL && delim != s21_NULL) {
+    s21_byteset_init(&set, delim, 0);
+    count = s21_split_kernel((const unsigned char *)str, len, &set, spans,
+                             spans != s21_NULL ? max : 0);
+  }
+  return count;
 }
 
 // OTHER FUNCTIONS
 
 void *s21_memset(void *str, int c, s21_size_t n) {
-  for (s21_size_t i = 0; i < n; i++) {
-    (*(char *)str) = c;
-    str++;
+  if (str != s21_NULL) s21_set_kernel((char *)str, (unsigned char)c, n);
+  return str;
+}
+
+static void *s21_memset_pattern(void *str, const void *pattern,
+                                s21_size_t len, s21_size_t n) {
+  unsigned char pattern16[16];
+  if (str != s21_NULL && pattern != s21_NULL) {
+    for (s21_size_t i = 0; i < 16; i++)
+      pattern16[i] = ((const unsigned char *)pattern)[i % len];
+    s21_fill16_kernel((char *)str, pattern16, n);
   }
-  return str - n;
+  return str;
 }
 
-char *s21_strerror(int errnum) {
-  char *err_list[] = LIST_ERRORS;
-  int flag;
-  char *error;
-  static char unknown_error[100] = {'\0'};
+void *s21_memset_pattern4(void *str, const void *pattern4, s21_size_t n) {
+  return s21_memset_pattern(str, pattern4, 4, n);
+}
+
+void *s21_memset_pattern8(void *str, const void *pattern8, s21_size_t n) {
+  return s21_memset_pattern(str, pattern8, 8, n);
+}
+
+void *s21_memset_pattern16(void *str, const void *pattern16, s21_size_t n) {
+  return s21_memset_pattern(str, pattern16, 16, n);
+}
 
+static const char *const s21_err_list[] = LIST_ERRORS;
+
+// Writes the message for an unknown error number, S21_UNKNOWN_ERROR and the
+// number in decimal, to buf, which must hold 32 bytes. Returns its length.
+static s21_size_t s21_unknown_error(char *buf, int errnum) {
+  char digits[12];
+  int count = 0;
+  unsigned value = errnum < 0 ? 0U - (unsigned)errnum : (unsigned)errnum;
+  s21_size_t len = sizeof(S21_UNKNOWN_ERROR) - 1;
+  s21_memcpy(buf, S21_UNKNOWN_ERROR, len);
+  do {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+  if (errnum < 0) buf[len++] = '-';
+  while (count) buf[len++] = digits[--count];
+  buf[len] = '\0';
+  return len;
+}
+
+char *s21_strerror(int errnum) {
+  static _Thread_local char unknown_error[32];
+  char *error = unknown_error;
   if (errnum >= 0 && errnum <= N) {
-    error = (char *)err_list[errnum];
-    flag = 1;
+    error = (char *)s21_err_list[errnum];
   } else {
-    s21_sprintf(unknown_error, "Unknown error: %d", errnum);
-    flag = 0;
+    s21_unknown_error(unknown_error, errnum);
   }
-  return (flag) ? error : unknown_error;
+  return error;
 }
 
-s21_size_t s21_strlen(const char *str) {
-  s21_size_t len = 0;
-  while (*str) {
-    len++;
-    str++;
+int s21_strerror_r(int errnum, char *buf, s21_size_t buflen) {
+  char unknown_error[32];
+  const char *error = unknown_error;
+  s21_size_t len;
+  int result = 0;
+  if (errnum >= 0 && errnum <= N) {
+    error = s21_err_list[errnum];
+    len = s21_strlen(error);
+  } else {
+    len = s21_unknown_error(unknown_error, errnum);
+    result = EINVAL;
   }
-  return len;
+  if (buf == s21_NULL || buflen == 0) {
+    result = ERANGE;
+  } else {
+    if (len >= buflen) {
+      len = buflen - 1;
+      result = ERANGE;
+    }
+    s21_memcpy(buf, error, len);
+    buf[len] = '\0';
+  }
+  return result;
 }
 
+s21_size_t s21_strlen(const char *str) { return s21_strlen_kernel(str); }
+
 // C# FUNCTIONS
 
-void *s21_to_upper(const char *str) {
-  char *answer = s21_NULL;
-  if (str) {
-    answer = (char *)calloc(s21_strlen(str) + 1, sizeof(char));
-    s21_strcpy(answer, str);
-    for (int i = 0; i < 1024 && answer[i]; i++) {
-      if (answer[i] >= 97 && answer[i] <= 122)
-        answer[i] = (char)((int)answer[i] - 32);
-    }
-  }
-  return answer;
+// Memory for the result of a C# function: from arena when there is one,
+// otherwise from s21_malloc for the caller to s21_free.
+static char *s21_result_alloc(s21_arena *arena, s21_size_t size) {
+  return arena != s21_NULL ? s21_arena_alloc(arena, size) : s21_malloc(size);
 }
 
-void *s21_to_lower(const char *str) {
+// Copy of str with the letters from..from+25 shifted by delta.
+static char *s21_case_copy(s21_arena *arena, const char *str, char from,
+                           int delta) {
   char *answer = s21_NULL;
   if (str) {
-    answer = (char *)calloc(s21_strlen(str) + 1, sizeof(char));
-    s21_strcpy(answer, str);
-    for (int i = 0; i < 1024 && answer[i]; i++) {
-      if (answer[i] >= 65 && answer[i] <= 90)
-        answer[i] = (char)((int)answer[i] + 32);
+    s21_size_t len = s21_strlen(str);
+    answer = s21_result_alloc(arena, len + 1);
+    for (s21_size_t i = 0; answer != s21_NULL && i <= len; i++) {
+      unsigned char c = (unsigned char)str[i];
+      answer[i] = (char)((unsigned)(c - from) < 26u ? c + delta : c);
     }
   }
   return answer;
 }
 
-void *s21_insert(const char *src, const char *str, s21_size_t start_index) {
-  s21_size_t i = 0;
+static char *s21_insert_in(s21_arena *arena, const char *src, const char *str,
+                           s21_size_t start_index) {
   char *result = s21_NULL;
-  if (src != s21_NULL && str != s21_NULL && s21_strlen(src) >= start_index) {
-    result = calloc(s21_strlen(src) + s21_strlen(str) + 1, sizeof(char));
-    for (; i < s21_strlen(str) + s21_strlen(src); i++) {
-      if (i < start_index) {
-        result[i] = src[i];
-      }
-      if (i >= start_index && i < start_index + s21_strlen(str)) {
-        result[i] = str[i - start_index];
-      }
-      if (i >= start_index + s21_strlen(str)) {
-        result[i] = src[i - s21_strlen(str)];
-      }
+  s21_size_t src_len = src != s21_NULL ? s21_strlen(src) : 0;
+  if (src != s21_NULL && str != s21_NULL && src_len >= start_index) {
+    s21_size_t str_len = s21_strlen(str);
+    result = s21_result_alloc(arena, src_len + str_len + 1);
+    if (result != s21_NULL) {
+      s21_memcpy(result, src, start_index);
+      s21_memcpy(result + start_index, str, str_len);
+      s21_memcpy(result + start_index + str_len, src + start_index,
+                 src_len - start_index + 1);
     }
   }
   return result;
 }
 
-void *s21_trim(const char *src, const char *trim_chars) {
+static char *s21_trim_in(s21_arena *arena, const char *src,
+                         const char *trim_chars) {
   if (src == s21_NULL) return s21_NULL;
-  char def_trim_chars[1024];
-  if (trim_chars != s21_NULL && s21_strlen(trim_chars) != 0)
-    s21_strcpy(def_trim_chars, trim_chars);
-  else
-    s21_strcpy(def_trim_chars, "\t\n\v\r\f ");
-  int len = s21_strlen(src);
-  int newlength = len;
-  char *srcfirst = (char *)src;
-  char *srclast = (char *)src + len;
-  if (len > 0) srclast--;
-  while (s21_strchr(def_trim_chars, *srcfirst) && *srcfirst) {
-    srcfirst++;
-    newlength--;
-  }
-  while (s21_strchr(def_trim_chars, *srclast) && newlength > 0) {
-    srclast--;
-    newlength--;
-  }
-  char *newstr = malloc(sizeof(char) * (newlength + 1));
+  s21_byteset set;
+  if (trim_chars == s21_NULL || *trim_chars == '\0')
+    trim_chars = "\t\n\v\r\f ";
+  s21_byteset_init(&set, trim_chars, 0);
+  s21_size_t start = s21_span_kernel((const unsigned char *)src, &set, 1);
+  s21_size_t len = start + s21_strlen(src + start);
+  while (len > start && S21_BYTESET_HAS(&set, src[len - 1])) len--;
+  char *newstr = s21_result_alloc(arena, len - start + 1);
   if (newstr) {
-    int i = 0;
-    while (i < newlength) {
-      newstr[i] = *srcfirst;
-      srcfirst++;
-      i++;
-    }
-    newstr[newlength] = '\0';
+    s21_memcpy(newstr, src + start, len - start);
+    newstr[len - start] = '\0';
   }
   return newstr;
 }
+
+void *s21_to_upper(const char *str) {
+  return s21_case_copy(s21_NULL, str, 'a', -32);
+}
+
+void *s21_to_lower(const char *str) {
+  return s21_case_copy(s21_NULL, str, 'A', 32);
+}
+
+void *s21_insert(const char *src, const char *str, s21_size_t start_index) {
+  return s21_insert_in(s21_NULL, src, str, start_index);
+}
+
+void *s21_trim(const char *src, const char *trim_chars) {
+  return s21_trim_in(s21_NULL, src, trim_chars);
+}
+
+char *s21_to_upper_arena(s21_arena *arena, const char *str) {
+  return s21_case_copy(arena, str, 'a', -32);
+}
+
+char *s21_to_lower_arena(s21_arena *arena, const char *str) {
+  return s21_case_copy(arena, str, 'A', 32);
+}
+
+char *s21_insert_arena(s21_arena *arena, const char *src, const char *str,
+                       s21_size_t start_index) {
+  return s21_insert_in(arena, src, str, start_index);
+}
+
+char *s21_trim_arena(s21_arena *arena, const char *src,
+                     const char *trim_chars) {
+  return s21_trim_in(arena, src, trim_chars);
+}
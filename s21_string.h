@@ -4,13 +4,12 @@
 #include <limits.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #define s21_NULL ((void *)0)
 #define s21_size_t unsigned long long
 
-#define BUFFERSIZE 1024
-#define EPSILON_VALUE 0.000001f
 #define SPACE_SYM " \n\r\t\v\f"
 
 typedef struct {
@@ -29,6 +28,36 @@ typedef struct {
   char unsign;
 } Format;
 
+/**
+ * @brief Set of bytes used by the span functions and the tokenizer, kept as a
+ * 256-bit bitmap for scalar code and as nibble tables for the vector kernels.
+ * Row rows[lo] (lo being the low nibble of a byte) has bit (hi & 7) set when
+ * the byte is in the set; rows 0-15 hold high nibbles 0-7 and rows 16-31 high
+ * nibbles 8-15. The fields are private.
+ */
+typedef struct {
+  unsigned long long bits[4];
+  unsigned char rows[32];
+} s21_byteset;
+
+/**
+ * @brief Piece of a buffer that is not null-terminated.
+ */
+typedef struct {
+  const char *ptr;
+  s21_size_t len;
+} s21_span_t;
+
+/**
+ * @brief State of s21_tokenizer_next, set up by s21_tokenizer_init. The fields
+ * are private.
+ */
+typedef struct {
+  const char *pos;
+  const char *end;
+  s21_byteset delims;
+} s21_tokenizer_t;
+
 // COPY FUNCTIONS
 
 /**
@@ -40,6 +69,23 @@ typedef struct {
  */
 void *s21_memcpy(void *dest, const void *src, s21_size_t n);
 
+/**
+ * @brief Sets the size from which s21_memcpy, s21_memmove and s21_memset
+ * switch to non-temporal stores that bypass the cache. The default is the size
+ * of the last level cache.
+ * @param bytes new threshold, 0 restores the default
+ * @return previous threshold
+ */
+s21_size_t s21_set_stream_threshold(s21_size_t bytes);
+
+/**
+ * @brief Debug query that names the kernel s21_memcpy runs for a copy of n
+ * bytes, e.g. "avx2-tiny", "avx2-loop" or "avx2-stream".
+ * @param n quantity of characters
+ * @return kernel name
+ */
+const char *s21_memcpy_kernel_name(s21_size_t n);
+
 /**
  * @brief Another function to copy n characters from src to dest.
  * @param dest string where copies
@@ -94,10 +140,22 @@ char *s21_strncat(char *dest, const char *src, s21_size_t n);
  * @param str1 pointer to first string
  * @param str2 pointer to second string
  * @param n quantity of bytes
- * @return comparison result 0 - identical 1 - not identical
+ * @return 0 if identical, otherwise the difference of the first differing
+ * bytes taken as unsigned char
  */
 int s21_memcmp(const void *str1, const void *str2, s21_size_t n);
 
+/**
+ * @brief Checks the first n bytes of str1 and str2 for equality. Cheaper
+ * than s21_memcmp when the order does not matter, with branch-free paths for
+ * keys of up to 32 bytes.
+ * @param str1 pointer to first string
+ * @param str2 pointer to second string
+ * @param n quantity of bytes
+ * @return 1 - identical 0 - not identical
+ */
+int s21_memeq(const void *str1, const void *str2, s21_size_t n);
+
 /**
  * @brief Compares str1 and str2.
  * @param str1 pointer to first string
@@ -127,6 +185,39 @@ int s21_strncmp(const char *str1, const char *str2, s21_size_t n);
  */
 void *s21_memchr(const void *str, int c, s21_size_t n);
 
+/**
+ * @brief Searches for the last occurrence of the character c (an unsigned
+ * char) in the first n bytes of the string pointed to, by the argument str.
+ * @param str pointer to string
+ * @param c sought character
+ * @param n quantity of bytes
+ * @return pointer to finded character in str
+ */
+void *s21_memrchr(const void *str, int c, s21_size_t n);
+
+/**
+ * @brief Searches the first n bytes of str for the first occurrence of
+ * either c1 or c2 in a single pass.
+ * @param str pointer to string
+ * @param c1 first sought character
+ * @param c2 second sought character
+ * @param n quantity of bytes
+ * @return pointer to finded character in str
+ */
+void *s21_memchr2(const void *str, int c1, int c2, s21_size_t n);
+
+/**
+ * @brief Searches the first n bytes of str for the first occurrence of c1,
+ * c2 or c3 in a single pass.
+ * @param str pointer to string
+ * @param c1 first sought character
+ * @param c2 second sought character
+ * @param c3 third sought character
+ * @param n quantity of bytes
+ * @return pointer to finded character in str
+ */
+void *s21_memchr3(const void *str, int c1, int c2, int c3, s21_size_t n);
+
 /**
  * @brief Searches for the first occurrence of the character c (an unsigned
  * char) in the string pointed to, by the argument str.
@@ -184,6 +275,105 @@ s21_size_t s21_strspn(const char *str1, const char *str2);
  */
 char *s21_strstr(const char *haystack, const char *needle);
 
+/**
+ * @brief Needle prepared once for many searches, see s21_searcher_compile.
+ */
+typedef struct s21_searcher s21_searcher_t;
+
+/**
+ * @brief Prepares needle for repeated searches. The algorithm is picked here:
+ * memchr for one byte, otherwise a vector filter on the two rarest bytes of
+ * the needle, backed by Two-Way for inputs that defeat it. The needle is
+ * copied.
+ * @param needle pointer to string needle
+ * @return searcher to release with s21_searcher_free, s21_NULL if needle is
+ * s21_NULL or memory is exhausted
+ */
+s21_searcher_t *s21_searcher_compile(const char *needle);
+
+/**
+ * @brief Finds the first occurrence of the compiled needle in the first len
+ * bytes of haystack. Null characters in haystack are ordinary bytes.
+ * @param searcher compiled needle
+ * @param haystack pointer to haystack
+ * @param len quantity of bytes in haystack
+ * @return pointer to first occurrence, s21_NULL if there is none
+ */
+char *s21_searcher_find(const s21_searcher_t *searcher, const char *haystack,
+                        s21_size_t len);
+
+/**
+ * @brief Debug query that names the algorithm a searcher runs: "empty",
+ * "memchr" or "pair".
+ * @param searcher compiled needle
+ * @return algorithm name
+ */
+const char *s21_searcher_algorithm(const s21_searcher_t *searcher);
+
+/**
+ * @brief Releases a searcher made by s21_searcher_compile.
+ * @param searcher compiled needle, may be s21_NULL
+ */
+void s21_searcher_free(s21_searcher_t *searcher);
+
+/**
+ * @brief Set of needles prepared once for single-pass search, see
+ * s21_multisearch_compile.
+ */
+typedef struct s21_multisearch s21_multisearch_t;
+
+/**
+ * @brief Called by s21_multisearch_scan for every match.
+ * @param id index of the needle in the array given to s21_multisearch_compile
+ * @param offset offset of the first byte of the match in haystack
+ * @param ctx pointer passed to s21_multisearch_scan
+ * @return 0 to go on, anything else to stop the scan
+ */
+typedef int (*s21_match_callback)(s21_size_t id, s21_size_t offset,
+                                  void *ctx);
+
+/**
+ * @brief Prepares a set of needles for search in a single pass. Sets of up to
+ * 16 needles use the Teddy vector filter when the CPU has AVX2, larger sets
+ * an Aho-Corasick automaton over byte classes. The needles are copied; empty
+ * needles never match.
+ * @param needles array of count strings
+ * @param count quantity of needles
+ * @return set to release with s21_multisearch_free, s21_NULL if needles or
+ * one of them is s21_NULL or memory is exhausted
+ */
+s21_multisearch_t *s21_multisearch_compile(const char *const *needles,
+                                           s21_size_t count);
+
+/**
+ * @brief Reports every occurrence of every needle in the first len bytes of
+ * haystack, overlapping ones included, to on_match. The order of the reports
+ * depends on the algorithm. Null characters in haystack are ordinary bytes.
+ * @param ms compiled set of needles
+ * @param haystack pointer to haystack
+ * @param len quantity of bytes in haystack
+ * @param on_match callback, may be s21_NULL to only count matches
+ * @param ctx pointer passed through to on_match
+ * @return quantity of matches reported
+ */
+s21_size_t s21_multisearch_scan(const s21_multisearch_t *ms,
+                                const char *haystack, s21_size_t len,
+                                s21_match_callback on_match, void *ctx);
+
+/**
+ * @brief Debug query that names the algorithm of a set: "teddy" or
+ * "aho-corasick".
+ * @param ms compiled set of needles
+ * @return algorithm name
+ */
+const char *s21_multisearch_algorithm(const s21_multisearch_t *ms);
+
+/**
+ * @brief Releases a set made by s21_multisearch_compile.
+ * @param ms compiled set of needles, may be s21_NULL
+ */
+void s21_multisearch_free(s21_multisearch_t *ms);
+
 /**
  * @brief Breaks string str into a series of tokens separated by delim.
  * @param pointer to string
@@ -192,6 +382,53 @@ char *s21_strstr(const char *haystack, const char *needle);
  */
 char *s21_strtok(char *str, const char *delim);
 
+/**
+ * @brief Reentrant s21_strtok: the position to go on from is kept in
+ * *saveptr instead of a static variable.
+ * @param str pointer to string for the first call, s21_NULL to go on
+ * @param delim pointer to delim
+ * @param saveptr pointer to state owned by the caller
+ * @return pointer to the next token, s21_NULL when there are no more
+ */
+char *s21_strtok_r(char *str, const char *delim, char **saveptr);
+
+/**
+ * @brief Starts splitting the first len bytes of str into tokens separated
+ * by runs of the characters of delim, like s21_strtok but without writing to
+ * str, so it works on read-only and memory-mapped buffers. Null characters
+ * in str are ordinary bytes.
+ * @param tok pointer to tokenizer state
+ * @param str pointer to buffer
+ * @param len quantity of bytes in buffer
+ * @param delim pointer to delim
+ */
+void s21_tokenizer_init(s21_tokenizer_t *tok, const char *str, s21_size_t len,
+                        const char *delim);
+
+/**
+ * @brief Finds the next token of a tokenizer.
+ * @param tok pointer to tokenizer state
+ * @param token pointer to span that receives the token
+ * @return 1 if a token was found, 0 at the end of the buffer
+ */
+int s21_tokenizer_next(s21_tokenizer_t *tok, s21_span_t *token);
+
+/**
+ * @brief Splits the first len bytes of str into fields at every character of
+ * delim in one pass. Unlike s21_strtok, adjacent delimiters make empty
+ * fields, so k delimiters always give k + 1 fields. The buffer is not
+ * changed and null characters in it are ordinary bytes.
+ * @param str pointer to buffer
+ * @param len quantity of bytes in buffer
+ * @param delim pointer to delim
+ * @param spans array that receives the first max fields, may be s21_NULL to
+ * only count them; entries past the fields found may be overwritten
+ * @param max capacity of spans
+ * @return quantity of fields in str, which may be more than max
+ */
+s21_size_t s21_split(const char *str, s21_size_t len, const char *delim,
+                     s21_span_t *spans, s21_size_t max);
+
 // OTHER FUNCTIONS
 
 /**
@@ -204,17 +441,62 @@ char *s21_strtok(char *str, const char *delim);
  */
 void *s21_memset(void *str, int c, s21_size_t n);
 
+/**
+ * @brief Fills the first n bytes of str with copies of a 4-byte pattern. The
+ * last copy is cut short if n is not a multiple of 4.
+ * @param str pointer to string
+ * @param pattern4 pointer to 4 bytes of pattern
+ * @param n quantity of bytes
+ * @return pointer to string
+ */
+void *s21_memset_pattern4(void *str, const void *pattern4, s21_size_t n);
+
+/**
+ * @brief Fills the first n bytes of str with copies of an 8-byte pattern.
+ * The last copy is cut short if n is not a multiple of 8.
+ * @param str pointer to string
+ * @param pattern8 pointer to 8 bytes of pattern
+ * @param n quantity of bytes
+ * @return pointer to string
+ */
+void *s21_memset_pattern8(void *str, const void *pattern8, s21_size_t n);
+
+/**
+ * @brief Fills the first n bytes of str with copies of a 16-byte pattern.
+ * The last copy is cut short if n is not a multiple of 16.
+ * @param str pointer to string
+ * @param pattern16 pointer to 16 bytes of pattern
+ * @param n quantity of bytes
+ * @return pointer to string
+ */
+void *s21_memset_pattern16(void *str, const void *pattern16, s21_size_t n);
+
 /**
  * @brief Searches an internal array for the error number errnum and returns a
  * pointer to an error message string. You need to declare macros containing
  * arrays of error messages for mac and linux operating systems. Error
  * descriptions are available in the original library. Checking the current OS
  * is carried out using directives.
+ * The table is static constant data; messages for unknown numbers are built
+ * in a buffer private to the calling thread, so concurrent calls never race.
+ * The string must not be modified and stays valid until the next call in the
+ * same thread.
  * @param errnum error number
  * @return pointer to error info string
  */
 char *s21_strerror(int errnum);
 
+/**
+ * @brief Copies the message of s21_strerror(errnum) into a buffer owned by
+ * the caller, truncated and null-terminated if it does not fit.
+ * @param errnum error number
+ * @param buf pointer to buffer
+ * @param buflen size of buffer
+ * @return 0 on success, EINVAL if errnum is unknown (the "Unknown error"
+ * message is still written), ERANGE if the message was truncated
+ */
+int s21_strerror_r(int errnum, char *buf, s21_size_t buflen);
+
 /**
  * @brief Computes the length of the string str up to but not including the
  * terminating null character.
@@ -223,6 +505,134 @@ char *s21_strerror(int errnum);
  */
 s21_size_t s21_strlen(const char *str);
 
+/**
+ * @brief Reports the vector extension the library kernels were dispatched to
+ * at load time. The S21_SIMD environment variable can lower it.
+ * @return "avx512", "avx2", "sse2" or "swar"
+ */
+const char *s21_simd_level(void);
+
+//==============ALLOCATORS==============//
+
+/**
+ * @brief Allocation hook: returns size bytes, or s21_NULL.
+ */
+typedef void *(*s21_alloc_fn)(s21_size_t size, void *ctx);
+
+/**
+ * @brief Reallocation hook with the semantics of realloc; ptr may be
+ * s21_NULL.
+ */
+typedef void *(*s21_realloc_fn)(void *ptr, s21_size_t size, void *ctx);
+
+/**
+ * @brief Release hook; never called with s21_NULL.
+ */
+typedef void (*s21_free_fn)(void *ptr, void *ctx);
+
+/**
+ * @brief Sends every allocation of the library (the C# functions, s21_str,
+ * s21_builder, memory sinks, s21_asprintf, compiled formats and searchers)
+ * to the given hooks instead of malloc. Meant to be called before other
+ * threads use the library. Memory is released through the hooks in effect
+ * at the time, so objects should not outlive a change of allocator.
+ * @param alloc allocation hook, s21_NULL to go back to malloc
+ * @param realloc_fn reallocation hook
+ * @param free_fn release hook
+ * @param ctx pointer passed to the hooks
+ */
+void s21_set_allocator(s21_alloc_fn alloc, s21_realloc_fn realloc_fn,
+                       s21_free_fn free_fn, void *ctx);
+
+/**
+ * @brief Like s21_set_allocator for the calling thread only, taking
+ * precedence over the process-wide hooks, e.g. to send one request's
+ * strings to a per-request arena.
+ * @param alloc allocation hook, s21_NULL to remove the override
+ * @param realloc_fn reallocation hook
+ * @param free_fn release hook
+ * @param ctx pointer passed to the hooks
+ */
+void s21_set_thread_allocator(s21_alloc_fn alloc, s21_realloc_fn realloc_fn,
+                              s21_free_fn free_fn, void *ctx);
+
+/**
+ * @brief Allocates through the current hooks, or malloc when none are set.
+ * @param size number of bytes
+ * @return memory, or s21_NULL
+ */
+void *s21_malloc(s21_size_t size);
+
+/**
+ * @brief Allocates count zeroed elements through the current hooks.
+ * @param count number of elements
+ * @param size size of an element
+ * @return memory, or s21_NULL, also when count * size overflows
+ */
+void *s21_calloc(s21_size_t count, s21_size_t size);
+
+/**
+ * @brief Resizes memory from s21_malloc through the current hooks.
+ * @param ptr memory, may be s21_NULL
+ * @param size new size
+ * @return memory, or s21_NULL with ptr left as it was
+ */
+void *s21_realloc(void *ptr, s21_size_t size);
+
+/**
+ * @brief Releases memory from s21_malloc or from a library function, such
+ * as the strings of the C# functions and s21_asprintf.
+ * @param ptr memory, may be s21_NULL
+ */
+void s21_free(void *ptr);
+
+// ARENA
+
+typedef struct s21_arena_chunk s21_arena_chunk;
+
+/**
+ * @brief Bump allocator for temporaries that die together, e.g. the strings
+ * of one request. Blocks are carved from chunks taken with s21_malloc and
+ * are never released one by one: s21_arena_reset drops all of them at once
+ * and keeps the chunks for reuse. The fields are private.
+ */
+typedef struct {
+  s21_arena_chunk *first;
+  s21_arena_chunk *current;
+  char *pos;
+  char *end;
+  s21_size_t chunk_size;
+} s21_arena;
+
+/**
+ * @brief Makes an empty arena; no memory is taken until the first block.
+ * @param arena arena
+ * @param chunk_size bytes per chunk, 0 for 4096; larger blocks get a chunk
+ * of their own
+ */
+void s21_arena_init(s21_arena *arena, s21_size_t chunk_size);
+
+/**
+ * @brief Takes size bytes aligned for any object type from arena.
+ * @param arena arena
+ * @param size number of bytes
+ * @return memory valid until the next reset, or s21_NULL
+ */
+void *s21_arena_alloc(s21_arena *arena, s21_size_t size);
+
+/**
+ * @brief Releases every block of arena at once. The chunks are kept, so a
+ * loop that resets after each request stops allocating once warmed up.
+ * @param arena arena
+ */
+void s21_arena_reset(s21_arena *arena);
+
+/**
+ * @brief Returns the chunks of arena to s21_free and leaves it empty.
+ * @param arena arena
+ */
+void s21_arena_free(s21_arena *arena);
+
 //==============C# FUNCTIONS==============//
 
 /**
@@ -266,217 +676,745 @@ void *s21_insert(const char *src, const char *str, s21_size_t start_index);
  */
 void *s21_trim(const char *src, const char *trim_chars);
 
+/**
+ * @brief s21_to_upper with the copy taken from arena.
+ * @param arena arena
+ * @param str pointer to string
+ * @return string valid until the arena is reset, or s21_NULL
+ */
+char *s21_to_upper_arena(s21_arena *arena, const char *str);
+
+/**
+ * @brief s21_to_lower with the copy taken from arena.
+ * @param arena arena
+ * @param str pointer to string
+ * @return string valid until the arena is reset, or s21_NULL
+ */
+char *s21_to_lower_arena(s21_arena *arena, const char *str);
+
+/**
+ * @brief s21_insert with the new string taken from arena.
+ * @param arena arena
+ * @param src given string
+ * @param str specified string
+ * @param start_index specified index position
+ * @return string valid until the arena is reset, or s21_NULL
+ */
+char *s21_insert_arena(s21_arena *arena, const char *src, const char *str,
+                       s21_size_t start_index);
+
+/**
+ * @brief s21_trim with the new string taken from arena.
+ * @param arena arena
+ * @param src given string
+ * @param trim_chars set of specified characters
+ * @return string valid until the arena is reset, or s21_NULL
+ */
+char *s21_trim_arena(s21_arena *arena, const char *src,
+                     const char *trim_chars);
+
+//==============S21_STR==============//
+
+/**
+ * @brief Characters a s21_str holds without a heap allocation.
+ */
+#define S21_STR_INLINE 23
+
+/**
+ * @brief Result of s21_str_find when there is no match.
+ */
+#define S21_STR_NPOS ((s21_size_t)-1)
+
+/**
+ * @brief String that carries its length, so that length lookups are O(1)
+ * and null characters are ordinary bytes. Up to S21_STR_INLINE characters
+ * are kept inside the struct; longer strings move to the heap, where the
+ * capacity grows by half or more. The characters are always followed by a
+ * null character. The fields are private: len holds the length, its top
+ * bit set while data.heap is in use.
+ */
+typedef struct {
+  s21_size_t len;
+  union {
+    struct {
+      char *ptr;
+      s21_size_t cap;
+    } heap;
+    char buf[S21_STR_INLINE + 1];
+  } data;
+} s21_str;
+
+/**
+ * @brief Makes s an empty string. No memory is allocated.
+ * @param s string to set up
+ */
+void s21_str_init(s21_str *s);
+
+/**
+ * @brief Sets up s with a copy of a C string.
+ * @param s string to set up
+ * @param cstr C string, s21_NULL for an empty string
+ * @return 0, or -1 if memory is exhausted
+ */
+int s21_str_from(s21_str *s, const char *cstr);
+
+/**
+ * @brief Releases the memory of s and leaves it empty.
+ * @param s string
+ */
+void s21_str_free(s21_str *s);
+
+/**
+ * @brief Length of s without any scan.
+ * @param s string
+ * @return number of characters
+ */
+s21_size_t s21_str_len(const s21_str *s);
+
+/**
+ * @brief Characters s can hold before it has to grow.
+ * @param s string
+ * @return capacity, at least S21_STR_INLINE
+ */
+s21_size_t s21_str_cap(const s21_str *s);
+
+/**
+ * @brief Characters of s as a null-terminated C string, valid until s
+ * changes.
+ * @param s string
+ * @return pointer to the characters
+ */
+const char *s21_str_cstr(const s21_str *s);
+
+/**
+ * @brief Characters of s for modification in place, s21_str_len of them.
+ * @param s string
+ * @return pointer to the characters
+ */
+char *s21_str_data(s21_str *s);
+
+/**
+ * @brief Makes room for cap characters, so that appends up to that length
+ * do not allocate.
+ * @param s string
+ * @param cap capacity wanted
+ * @return 0, or -1 if memory is exhausted
+ */
+int s21_str_reserve(s21_str *s, s21_size_t cap);
+
+/**
+ * @brief Replaces the contents of s with n bytes of data.
+ * @param s string
+ * @param data bytes, may point into s
+ * @param n number of bytes
+ * @return 0, or -1 if data is s21_NULL or memory is exhausted
+ */
+int s21_str_assign(s21_str *s, const char *data, s21_size_t n);
+
+/**
+ * @brief Appends n bytes of data to s in amortised O(n).
+ * @param s string
+ * @param data bytes, may point into s
+ * @param n number of bytes
+ * @return 0, or -1 if data is s21_NULL or memory is exhausted
+ */
+int s21_str_append(s21_str *s, const char *data, s21_size_t n);
+
+/**
+ * @brief s21_strcat for s21_str: appends src to dest.
+ * @param dest string appended to
+ * @param src string to append, may be dest
+ * @return 0, or -1 if memory is exhausted
+ */
+int s21_str_cat(s21_str *dest, const s21_str *src);
+
+/**
+ * @brief Appends a C string to dest.
+ * @param dest string appended to
+ * @param src C string
+ * @return 0, or -1 if src is s21_NULL or memory is exhausted
+ */
+int s21_str_cat_cstr(s21_str *dest, const char *src);
+
+/**
+ * @brief Compares two strings byte by byte like s21_memcmp; a string that
+ * is a prefix of the other is smaller.
+ * @param s1 first string
+ * @param s2 second string
+ * @return negative, 0 or positive value
+ */
+int s21_str_cmp(const s21_str *s1, const s21_str *s2);
+
+/**
+ * @brief Equality test that compares the lengths first.
+ * @param s1 first string
+ * @param s2 second string
+ * @return 1 if the strings are equal, 0 otherwise
+ */
+int s21_str_eq(const s21_str *s1, const s21_str *s2);
+
+/**
+ * @brief s21_strstr for s21_str, with the search of s21_strstr and no
+ * length scans.
+ * @param s string searched
+ * @param needle string to find
+ * @param from index to start at
+ * @return index of the first occurrence at or after from, or S21_STR_NPOS
+ */
+s21_size_t s21_str_find(const s21_str *s, const s21_str *needle,
+                        s21_size_t from);
+
+/**
+ * @brief s21_to_upper for s21_str, in place.
+ * @param s string
+ */
+void s21_str_to_upper(s21_str *s);
+
+/**
+ * @brief s21_to_lower for s21_str, in place.
+ * @param s string
+ */
+void s21_str_to_lower(s21_str *s);
+
+/**
+ * @brief s21_insert for s21_str, in place: inserts n bytes of data at index.
+ * @param s string
+ * @param index position, at most s21_str_len(s)
+ * @param data bytes, may point into s
+ * @param n number of bytes
+ * @return 0, or -1 if index is out of range, data is s21_NULL or memory is
+ * exhausted
+ */
+int s21_str_insert(s21_str *s, s21_size_t index, const char *data,
+                   s21_size_t n);
+
+/**
+ * @brief Inserts a C string into s at index.
+ * @param s string
+ * @param index position, at most s21_str_len(s)
+ * @param str C string
+ * @return 0, or -1 on an error
+ */
+int s21_str_insert_cstr(s21_str *s, s21_size_t index, const char *str);
+
+/**
+ * @brief s21_trim for s21_str, in place: removes leading and trailing
+ * characters of trim_chars.
+ * @param s string
+ * @param trim_chars set of characters, s21_NULL or "" for white space
+ */
+void s21_str_trim(s21_str *s, const char *trim_chars);
+
 //=========clear buff for tests==========//
 
 void clear_buffs(char **buffer, char **buffer2);
 
+// NUMBER CONVERSION
+
+/**
+ * @brief Writes the decimal digits of value and a null character. The
+ * digits are counted first and stored two at a time.
+ * @param value number
+ * @param buf buffer of at least 21 bytes
+ * @return number of digits written
+ */
+s21_size_t s21_u64toa(unsigned long long value, char *buf);
+
+/**
+ * @brief Writes value in decimal, with a '-' when it is negative, and a null
+ * character.
+ * @param value number
+ * @param buf buffer of at least 21 bytes
+ * @return number of characters written, the null character excluded
+ */
+s21_size_t s21_i64toa(long long value, char *buf);
+
+/**
+ * @brief Writes the hexadecimal digits of value, without a 0x prefix, and a
+ * null character.
+ * @param value number
+ * @param buf buffer of at least 17 bytes
+ * @param upper whether to use the letters A-F instead of a-f
+ * @return number of digits written
+ */
+s21_size_t s21_u64toa_hex(unsigned long long value, char *buf, int upper);
+
+/**
+ * @brief Writes the shortest decimal that reads back as value, the same text
+ * as s21_sprintf with %r, and a null character.
+ * @param value number
+ * @param buf buffer of at least 32 bytes
+ * @return number of characters written, the null character excluded
+ */
+s21_size_t s21_dtoa(double value, char *buf);
+
+/**
+ * @brief Reads an integer like strtoll: leading whitespace, a sign, a 0x or
+ * 0 prefix when base allows it, then digits. Eight decimal digits are
+ * checked and combined at a time.
+ * @param str pointer to string
+ * @param endptr receives the position after the number, or str if there is
+ * none; may be s21_NULL
+ * @param base 2 to 36, or 0 to take it from the prefix
+ * @return value, saturated at LLONG_MIN or LLONG_MAX with errno set to ERANGE
+ */
+long long s21_strtoll(const char *str, char **endptr, int base);
+
+/**
+ * @brief s21_strtoll for unsigned numbers; a '-' negates the result.
+ * @param str pointer to string
+ * @param endptr receives the position after the number; may be s21_NULL
+ * @param base 2 to 36, or 0 to take it from the prefix
+ * @return value, or ULLONG_MAX with errno set to ERANGE
+ */
+unsigned long long s21_strtoull(const char *str, char **endptr, int base);
+
+/**
+ * @brief Reads a double like strtod, rounded correctly: decimal and
+ * hexadecimal numbers, inf, infinity and nan. Most numbers take the
+ * Eisel-Lemire fast path; the rare ties it cannot decide are settled with
+ * exact big-number arithmetic.
+ * @param str pointer to string
+ * @param endptr receives the position after the number; may be s21_NULL
+ * @return value, with errno set to ERANGE on overflow and underflow
+ */
+double s21_strtod(const char *str, char **endptr);
+
 //===============SPRINTF==============//
 
 /**
- * @brief sends formatted output to a string pointed to, by str.
+ * @brief sends formatted output to a string pointed to, by str. Besides the
+ * standard conversions, %r (%R) prints the shortest digits that read back as
+ * the same double, or long double with L, in %g style; a precision caps them
+ * at that many significant digits, correctly rounded.
  * @param str pointer to string
  * @param format pointer to output string
  * @return length of str
  */
 int s21_sprintf(char *str, const char *format, ...);
 
-// SPECIAL FUNCTIONS FOR SPRINTF
+/**
+ * @brief Like s21_sprintf, but writes at most size bytes, the terminating null
+ * character included. With str NULL and size 0 nothing is written, which
+ * gives the length of a buffer to allocate.
+ * @param str pointer to string, may be NULL when size is 0
+ * @param size size of the buffer str points to
+ * @param format pointer to format string
+ * @return length the whole output would have, without the null character,
+ * or -1 on a malformed format; the output was cut when it is size or more
+ */
+int s21_snprintf(char *str, s21_size_t size, const char *format, ...);
 
 /**
- * @brief Support function for parcing sprintf flags
- * @param format pointer to output string
- * @param i pointer to iterator in output string
- * @param form pointer to struct that contains info about flags and specs
+ * @brief s21_sprintf with the arguments in a va_list.
+ * @param str pointer to string
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vsprintf
+ * @return length of str
  */
-void s21_parse_flags(const char *format, s21_size_t *i, Format *form);
+int s21_vsprintf(char *str, const char *format, va_list ap);
 
 /**
- * @brief Support function for parcing width info
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param format pointer to output string
- * @param i pointer to iterator in output string
- * @param form pointer to struct that contains info about flags and specs
+ * @brief s21_snprintf with the arguments in a va_list.
+ * @param str pointer to string, may be NULL when size is 0
+ * @param size size of the buffer str points to
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vsnprintf
+ * @return length the whole output would have, or -1
  */
-void s21_parse_width(va_list *ap, const char *format, s21_size_t *i,
-                     Format *form);
+int s21_vsnprintf(char *str, s21_size_t size, const char *format, va_list ap);
 
 /**
- * @brief Support function for parcing accuracy info
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param format pointer to output string
- * @param i pointer to iterator in output string
- * @param form pointer to struct that contains info about flags and specs
+ * @brief Format string parsed once by s21_format_compile into directives and
+ * literal text. The structure is private.
  */
-void s21_parse_accuracy(va_list *ap, const char *format, s21_size_t *i,
-                        Format *form);
+typedef struct s21_format s21_format_t;
 
 /**
- * @brief Support function for parcing length info
- * @param format pointer to output string
- * @param i pointer to iterator in output string
- * @param form pointer to struct that contains info about flags and specs
+ * @brief Parses format for repeated use with s21_format_snprintf, which then
+ * skips the parsing s21_snprintf does on every call.
+ * @param format pointer to format string, copied
+ * @return compiled format to release with s21_format_free, s21_NULL if
+ * format is NULL or ends inside a directive, or memory ran out
  */
-void s21_parse_length(const char *format, s21_size_t *i, Format *form);
+s21_format_t *s21_format_compile(const char *format);
 
 /**
- * @brief Support function for parcing specificator
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param j pointer to iterator in output string
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief s21_snprintf with a compiled format.
+ * @param str pointer to string, may be NULL when size is 0
+ * @param size size of the buffer str points to
+ * @param fmt compiled format
+ * @return length the whole output would have, or -1 past INT_MAX
  */
-char *s21_switch_spec(va_list *ap, s21_size_t j, Format *form);
+int s21_format_snprintf(char *str, s21_size_t size, const s21_format_t *fmt,
+                        ...);
 
 /**
- * @brief Function that processing 'n' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param j pointer to iterator in output string
- * @return pointer to string
+ * @brief s21_format_snprintf with the arguments in a va_list.
+ * @param str pointer to string, may be NULL when size is 0
+ * @param size size of the buffer str points to
+ * @param fmt compiled format
+ * @param ap arguments, left indeterminate as with vsnprintf
+ * @return length the whole output would have, or -1 past INT_MAX
  */
-char *s21_process_spec_n(va_list *ap, s21_size_t j);
+int s21_format_vsnprintf(char *str, s21_size_t size, const s21_format_t *fmt,
+                         va_list ap);
 
 /**
- * @brief Function that processing 'i' 'd' specs
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Releases a compiled format.
+ * @param fmt compiled format or s21_NULL
  */
-char *s21_process_spec_id(va_list *ap, Format *form);
+void s21_format_free(s21_format_t *fmt);
+
+// SINKS
 
 /**
- * @brief Function that processing 'x' 'X' 'o' specs and unsigned
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Buffered destination of s21_sink_printf. Output collects in buf and
+ * flush is called when it is full: it has to empty buf (write len bytes out
+ * and set len to 0) or make it larger (change buf and size). It is also
+ * called with need 0 by s21_sink_flush, where only the first is expected.
+ * A flush that returns nonzero leaves the sink failed: error is set and
+ * later output is dropped.
  */
-char *s21_process_spec_xuo(va_list *ap, Format *form);
+typedef struct s21_sink {
+  char *buf;
+  s21_size_t size;
+  s21_size_t len;
+  int (*flush)(struct s21_sink *sink, s21_size_t need);
+  void *ctx;
+  int fd;
+  int error;
+} s21_sink;
 
 /**
- * @brief Function that processing 'p' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Sets up a sink with a custom flush callback.
+ * @param sink sink to set up
+ * @param flush callback that empties or grows the buffer, 0 on success
+ * @param ctx pointer kept in sink->ctx for the callback
+ * @param buf buffer, may be NULL with size 0 for a flush that grows it
+ * @param size size of buf
  */
-char *s21_process_spec_p(va_list *ap, Format *form);
+void s21_sink_init(s21_sink *sink, int (*flush)(s21_sink *, s21_size_t),
+                   void *ctx, char *buf, s21_size_t size);
 
 /**
- * @brief Function that processing 'f' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Sink that writes to a file descriptor with write(2), one call per
+ * full buffer, so any number of records costs one write until buf fills.
+ * @param sink sink to set up
+ * @param fd file descriptor
+ * @param buf buffer, a few KiB is typical
+ * @param size size of buf, at least 1
  */
-char *s21_process_spec_f(va_list *ap, Format *form);
+void s21_sink_fd(s21_sink *sink, int fd, char *buf, s21_size_t size);
 
 /**
- * @brief Function that processing 'e' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Sink that writes to a stream with fwrite, one call per full buffer.
+ * @param sink sink to set up
+ * @param stream stream
+ * @param buf buffer
+ * @param size size of buf, at least 1
  */
-char *s21_process_spec_e(va_list *ap, Format *form);
+void s21_sink_file(s21_sink *sink, FILE *stream, char *buf, s21_size_t size);
 
 /**
- * @brief Function that processing 'g' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Sink that keeps the output in memory, growing the buffer by half
+ * its size or more with realloc. The output is sink->buf[0..sink->len), not
+ * null-terminated; release sink->buf with s21_free.
+ * @param sink sink to set up
  */
-char *s21_process_spec_g(va_list *ap, Format *form);
+void s21_sink_mem(s21_sink *sink);
 
 /**
- * @brief Function that processing 'c' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Appends bytes to a sink.
+ * @param sink sink
+ * @param data bytes to append
+ * @param len number of bytes
+ * @return 0, or -1 if the sink has failed
  */
-char *s21_process_spec_c(va_list *ap, Format *form);
+int s21_sink_write(s21_sink *sink, const char *data, s21_size_t len);
 
 /**
- * @brief Function that processing 's' spec
- * @param ap pointer to complete object type suitable for holding the
- * information needed by the macros va_start and va_end.
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Hands the buffered output to the flush callback.
+ * @param sink sink
+ * @return 0, or -1 if the sink has failed
  */
-char *s21_process_spec_s(va_list *ap, Format *form);
+int s21_sink_flush(s21_sink *sink);
 
 /**
- * @brief Function for reverses string
- * @param str pointer to string
- * @param len string's length
+ * @brief Formats like s21_sprintf into a sink. The output stays buffered
+ * until the buffer fills or s21_sink_flush is called.
+ * @param sink sink
+ * @param format pointer to format string
+ * @return number of characters formatted, or -1 on a malformed format or if
+ * the sink has failed
  */
-void s21_reverse(char str[], int len);
+int s21_sink_printf(s21_sink *sink, const char *format, ...);
 
 /**
- * @brief Function that processing flags
- * @param str pointer to string
- * @param form pointer to struct that contains info about flags and specs
+ * @brief s21_sink_printf with the arguments in a va_list.
+ * @param sink sink
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vsprintf
+ * @return number of characters formatted, or -1
  */
-void s21_process_flags(char *str, Format *form);
+int s21_sink_vprintf(s21_sink *sink, const char *format, va_list ap);
 
 /**
- * @brief Function that transform integer to string
- * @param num number
- * @param base the base of the number
- * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
+ * @brief Formats like s21_sprintf and writes the result to stream through a
+ * stack buffer, without a temporary string.
+ * @param stream stream
+ * @param format pointer to format string
+ * @return number of characters written, or -1
  */
-char *s21_itoa(long long num, int base, Format *form);
+int s21_fprintf(FILE *stream, const char *format, ...);
 
 /**
- * @brief Function that transform string to number
- * @param str pointer to string
- * @return number
+ * @brief s21_fprintf with the arguments in a va_list.
+ * @param stream stream
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vfprintf
+ * @return number of characters written, or -1
+ */
+int s21_vfprintf(FILE *stream, const char *format, va_list ap);
+
+/**
+ * @brief Formats like s21_sprintf and writes the result to fd, with one
+ * write(2) for output up to 4 KiB. Bursts of records are batched by an
+ * s21_sink_fd kept across calls.
+ * @param fd file descriptor
+ * @param format pointer to format string
+ * @return number of characters written, or -1
+ */
+int s21_dprintf(int fd, const char *format, ...);
+
+/**
+ * @brief s21_dprintf with the arguments in a va_list.
+ * @param fd file descriptor
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vdprintf
+ * @return number of characters written, or -1
+ */
+int s21_vdprintf(int fd, const char *format, va_list ap);
+
+/**
+ * @brief Formats like s21_sprintf into a newly allocated string of the
+ * right size, in a single pass.
+ * @param strp receives the string, to release with s21_free, or s21_NULL on
+ * error
+ * @param format pointer to format string
+ * @return length of the string, or -1 on a malformed format or if memory
+ * ran out
+ */
+int s21_asprintf(char **strp, const char *format, ...);
+
+/**
+ * @brief s21_asprintf with the arguments in a va_list.
+ * @param strp receives the string, to release with s21_free, or s21_NULL
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vasprintf
+ * @return length of the string, or -1
+ */
+int s21_vasprintf(char **strp, const char *format, va_list ap);
+
+/**
+ * @brief s21_asprintf with the string taken from arena. Most strings fit
+ * in the free space of the current chunk and are formatted in place in a
+ * single pass; the others are formatted again into a block of the right
+ * size.
+ * @param arena arena
+ * @param strp receives the string, valid until the arena is reset, or
+ * s21_NULL on error
+ * @param format pointer to format string
+ * @return length of the string, or -1
+ */
+int s21_asprintf_arena(s21_arena *arena, char **strp, const char *format,
+                       ...);
+
+/**
+ * @brief s21_asprintf_arena with the arguments in a va_list.
+ * @param arena arena
+ * @param strp receives the string, or s21_NULL
+ * @param format pointer to format string
+ * @param ap arguments, left indeterminate as with vasprintf
+ * @return length of the string, or -1
+ */
+int s21_vasprintf_arena(s21_arena *arena, char **strp, const char *format,
+                        va_list ap);
+
+// BUILDER
+
+/**
+ * @brief String builder over a memory sink. The buffer grows by half its
+ * size or more, so every append is amortised O(1) per byte and nothing is
+ * scanned again, unlike a chain of s21_strcat calls. Errors are sticky:
+ * after a failed allocation appends do nothing and s21_builder_finish
+ * returns s21_NULL.
+ */
+typedef struct {
+  s21_sink sink;
+} s21_builder;
+
+/**
+ * @brief Makes b an empty builder. No memory is allocated yet.
+ * @param b builder to set up
+ */
+void s21_builder_init(s21_builder *b);
+
+/**
+ * @brief Makes room for n more bytes, so that appends up to that size do
+ * not allocate.
+ * @param b builder
+ * @param n number of bytes
+ * @return 0, or -1 if the builder has failed
+ */
+int s21_builder_reserve(s21_builder *b, s21_size_t n);
+
+/**
+ * @brief Appends n bytes of data.
+ * @param b builder
+ * @param data bytes
+ * @param n number of bytes
+ * @return 0, or -1 if the builder has failed
+ */
+int s21_builder_append(s21_builder *b, const char *data, s21_size_t n);
+
+/**
+ * @brief Appends a C string without its null character.
+ * @param b builder
+ * @param str C string
+ * @return 0, or -1 if the builder has failed
+ */
+int s21_builder_append_cstr(s21_builder *b, const char *str);
+
+/**
+ * @brief Appends one character.
+ * @param b builder
+ * @param c character
+ * @return 0, or -1 if the builder has failed
  */
-long long s21_atoi(char *str);
+int s21_builder_append_char(s21_builder *b, char c);
 
 /**
- * @brief Function that transform float to string
- * @param f number
- * @param acc accuracy
+ * @brief Appends an integer in decimal, converted in place by s21_i64toa.
+ * @param b builder
+ * @param value number
+ * @return 0, or -1 if the builder has failed
+ */
+int s21_builder_append_int(s21_builder *b, long long value);
+
+/**
+ * @brief Appends an unsigned integer in decimal.
+ * @param b builder
+ * @param value number
+ * @return 0, or -1 if the builder has failed
+ */
+int s21_builder_append_uint(s21_builder *b, unsigned long long value);
+
+/**
+ * @brief Appends formatted text, written by the sprintf engine straight
+ * into the buffer.
+ * @param b builder
+ * @param format pointer to format string
+ * @return number of characters appended, or -1 on an error
+ */
+int s21_builder_printf(s21_builder *b, const char *format, ...);
+
+/**
+ * @brief s21_builder_printf with the arguments in a va_list.
+ * @param b builder
+ * @param format pointer to format string
+ * @param ap arguments
+ * @return number of characters appended, or -1 on an error
+ */
+int s21_builder_vprintf(s21_builder *b, const char *format, va_list ap);
+
+/**
+ * @brief Number of bytes appended so far.
+ * @param b builder
+ * @return length
+ */
+s21_size_t s21_builder_len(const s21_builder *b);
+
+/**
+ * @brief Null-terminates the text and hands its buffer over without a
+ * copy. The builder is left empty and can be used again.
+ * @param b builder
+ * @param len receives the length of the text, may be s21_NULL
+ * @return the text, to release with s21_free, or s21_NULL if the builder has
+ * failed
+ */
+char *s21_builder_finish(s21_builder *b, s21_size_t *len);
+
+/**
+ * @brief Drops the text and releases the buffer. The builder is left empty.
+ * @param b builder
+ */
+void s21_builder_free(s21_builder *b);
+
+// SPECIAL FUNCTIONS FOR SPRINTF
+
+/**
+ * @brief Support function for parcing sprintf flags
+ * @param format pointer to output string
+ * @param i pointer to iterator in output string
  * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
  */
-char *s21_ftoa(long double f, int acc, Format *form);
-// убирает нули в конце числа
+void s21_parse_flags(const char *format, s21_size_t *i, Format *form);
 
 /**
- * @brief Function that delete zeros in the end of number
- * @param str pointer to string that contains number
+ * @brief Support function for parcing width info
+ * @param ap pointer to complete object type suitable for holding the
+ * information needed by the macros va_start and va_end.
+ * @param format pointer to output string
+ * @param i pointer to iterator in output string
+ * @param form pointer to struct that contains info about flags and specs
  */
-void s21_delete_zero(char *str);
+void s21_parse_width(va_list *ap, const char *format, s21_size_t *i,
+                     Format *form);
 
 /**
- * @brief Function that transform float to string by exponential notation of a
- * number
- * @param f number
+ * @brief Support function for parcing accuracy info
+ * @param ap pointer to complete object type suitable for holding the
+ * information needed by the macros va_start and va_end.
+ * @param format pointer to output string
+ * @param i pointer to iterator in output string
  * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
  */
-char *s21_ftoexp(long double f, Format *form);
+void s21_parse_accuracy(va_list *ap, const char *format, s21_size_t *i,
+                        Format *form);
 
 /**
- * @brief Function that transform float to string by exponential notation of a
- * number or float (in dependence of length)
- * @param f number
+ * @brief Support function for parcing length info
+ * @param format pointer to output string
+ * @param i pointer to iterator in output string
  * @param form pointer to struct that contains info about flags and specs
- * @return pointer to string
  */
-char *s21_ftog(long double f, Format *form);
+void s21_parse_length(const char *format, s21_size_t *i, Format *form);
+
+//===============SSCANF==============//
+
+/**
+ * @brief reads formatted input from a string: d, i, u, o, x, X, p, the float
+ * conversions, s, c, [set] and n, with *, widths and hh, h, l, ll and L.
+ * @param str pointer to input string
+ * @param format pointer to format string
+ * @return number of assigned fields, or EOF if the input ended before the
+ * first conversion
+ */
+int s21_sscanf(const char *str, const char *format, ...);
+
+/**
+ * @brief s21_sscanf with the arguments in a va_list.
+ * @param str pointer to input string
+ * @param format pointer to format string
+ * @param ap arguments
+ * @return number of assigned fields, or EOF
+ */
+int s21_vsscanf(const char *str, const char *format, va_list ap);
 
 #if defined(__APPLE__)
 #define N 106
+#define S21_UNKNOWN_ERROR "Unknown error: "
 #define LIST_ERRORS                                                            \
   {                                                                            \
     "Undefined error: 0", "Operation not permitted",                           \
@@ -531,6 +1469,7 @@ char *s21_ftog(long double f, Format *form);
 
 #elif defined(__linux__)
 #define N 133
+#define S21_UNKNOWN_ERROR "Unknown error "
 #define LIST_ERRORS                                                            \
   {                                                                            \
     "Success", "Operation not permitted", "No such file or directory",         \
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../s21_string.h"
+
+#define ROUNDS 300000
+#define REPEATS 5
+#define NUMBERS 200000
+#define RECORDS 20000
+
+typedef int (*format_fn)(char *buf, const char *format,
+                         const s21_format_t *fmt, int i);
+
+static const char *formats[] = {
+    "%s [%5s] pid=%d tid=%u req=%08x user=%-10s bytes=%lld status=%d",
+    "GET %s %d %llu bytes in %dus from %s:%u",
+    "%-8s|%8d|%#10x|%+6d|%5.3s|%c%c%c"};
+
+static int run_libc(char *buf, const char *format, const s21_format_t *fmt,
+                    int i) {
+  (void)fmt;
+  if (format == formats[0])
+    return snprintf(buf, 256, format, "2026-10-17T12:00:00", "INFO", 1234 + i,
+                    77u, (unsigned)i * 2654435761u, "alice",
+                    (long long)i * 1000, 200);
+  if (format == formats[1])
+    return snprintf(buf, 256, format, "/api/v1/items", 200,
+                    (unsigned long long)i << 4, i % 5000, "10.0.0.1", 443u);
+  return snprintf(buf, 256, format, "key", i, i, -i, "value", 'a', 'b', 'c');
+}
+
+static int run_parsed(char *buf, const char *format, const s21_format_t *fmt,
+                      int i) {
+  (void)fmt;
+  if (format == formats[0])
+    return s21_snprintf(buf, 256, format, "2026-10-17T12:00:00", "INFO",
+                        1234 + i, 77u, (unsigned)i * 2654435761u, "alice",
+                        (long long)i * 1000, 200);
+  if (format == formats[1])
+    return s21_snprintf(buf, 256, format, "/api/v1/items", 200,
+                        (unsigned long long)i << 4, i % 5000, "10.0.0.1",
+                        443u);
+  return s21_snprintf(buf, 256, format, "key", i, i, -i, "value", 'a', 'b',
+                      'c');
+}
+
+static int run_compiled(char *buf, const char *format,
+                        const s21_format_t *fmt, int i) {
+  if (format == formats[0])
+    return s21_format_snprintf(buf, 256, fmt, "2026-10-17T12:00:00", "INFO",
+                               1234 + i, 77u, (unsigned)i * 2654435761u,
+                               "alice", (long long)i * 1000, 200);
+  if (format == formats[1])
+    return s21_format_snprintf(buf, 256, fmt, "/api/v1/items", 200,
+                               (unsigned long long)i << 4, i % 5000,
+                               "10.0.0.1", 443u);
+  return s21_format_snprintf(buf, 256, fmt, "key", i, i, -i, "value", 'a',
+                             'b', 'c');
+}
+
+// Best of REPEATS runs, which filters out noise from other processes.
+static double measure(format_fn fn, const char *format,
+                      const s21_format_t *fmt) {
+  char buf[256];
+  unsigned long long sum = 0;
+  double best = 0;
+  for (int rep = 0; rep < REPEATS; rep++) {
+    clock_t start = clock();
+    for (int i = 0; i < ROUNDS; i++) sum += fn(buf, format, fmt, i);
+    double ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ROUNDS;
+    if (rep == 0 || ns < best) best = ns;
+  }
+  // Keeps the calls from being optimised away.
+  if (sum == 0) printf("%s\n", buf);
+  return best;
+}
+
+typedef double (*parse_fn)(const char *str, char **end);
+
+static double libc_strtod(const char *str, char **end) {
+  return strtod(str, end);
+}
+
+static double libc_strtoll(const char *str, char **end) {
+  return (double)strtoll(str, end, 10);
+}
+
+static double s21_strtoll_10(const char *str, char **end) {
+  return (double)s21_strtoll(str, end, 10);
+}
+
+// Parsing speed over newline separated numbers in GB/s, best of REPEATS.
+static double measure_parse(parse_fn fn, const char *text, s21_size_t len) {
+  double sum = 0, best = 0;
+  for (int rep = 0; rep < REPEATS; rep++) {
+    char *p = (char *)text;
+    clock_t start = clock();
+    for (int i = 0; i < NUMBERS; i++) sum += fn(p + 1, &p);
+    double gbs = len / ((double)(clock() - start) / CLOCKS_PER_SEC) / 1e9;
+    if (gbs > best) best = gbs;
+  }
+  if (sum == 0) printf("%s\n", text);
+  return best;
+}
+
+// Text of NUMBERS random doubles or integers, each after a newline.
+static char *number_text(int doubles, s21_size_t *len) {
+  char *text = malloc(NUMBERS * 32 + 1), *p = text;
+  unsigned long long state = 88172645463325252ULL;
+  if (text == s21_NULL) return s21_NULL;
+  for (int i = 0; i < NUMBERS; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    if (doubles)
+      p += sprintf(p, "\n%.17g", (double)(state >> 11) / (1ULL << 43));
+    else
+      p += sprintf(p, "\n%lld", (long long)(state >> 1));
+  }
+  *len = (s21_size_t)(p - text);
+  return text;
+}
+
+// Milliseconds to build RECORDS lines with s21_strcat, which scans the
+// whole text for every line, or with a builder.
+static double measure_concat(int builder) {
+  static char text[RECORDS * 48];
+  const char *line = "status=200 bytes=4096 path=/api/v1/items\n";
+  double best = 0;
+  for (int rep = 0; rep < REPEATS; rep++) {
+    s21_builder b;
+    s21_builder_init(&b);
+    text[0] = '\0';
+    clock_t start = clock();
+    for (int i = 0; i < RECORDS; i++) {
+      if (builder)
+        s21_builder_append_cstr(&b, line);
+      else
+        s21_strcat(text, line);
+    }
+    double ms = (double)(clock() - start) / CLOCKS_PER_SEC * 1e3;
+    if (rep == 0 || ms < best) best = ms;
+    s21_builder_free(&b);
+  }
+  return best;
+}
+
+// Milliseconds for RECORDS requests that each make four temporary strings,
+// released one by one with s21_free or all at once by an arena reset.
+static double measure_request(int use_arena) {
+  const char *line = "  status=200 bytes=4096 path=/api/v1/items\n";
+  double best = 0;
+  s21_size_t sum = 0;
+  for (int rep = 0; rep < REPEATS; rep++) {
+    s21_arena arena;
+    s21_arena_init(&arena, 0);
+    clock_t start = clock();
+    for (int i = 0; i < RECORDS; i++) {
+      char *trimmed, *upper, *inserted, *formatted;
+      if (use_arena) {
+        trimmed = s21_trim_arena(&arena, line, s21_NULL);
+        upper = s21_to_upper_arena(&arena, trimmed);
+        inserted = s21_insert_arena(&arena, upper, "GET ", 0);
+        s21_asprintf_arena(&arena, &formatted, "%d %s", i, inserted);
+      } else {
+        trimmed = s21_trim(line, s21_NULL);
+        upper = s21_to_upper(trimmed);
+        inserted = s21_insert(upper, "GET ", 0);
+        s21_asprintf(&formatted, "%d %s", i, inserted);
+      }
+      sum += formatted[0];
+      if (use_arena) {
+        s21_arena_reset(&arena);
+      } else {
+        s21_free(trimmed);
+        s21_free(upper);
+        s21_free(inserted);
+        s21_free(formatted);
+      }
+    }
+    double ms = (double)(clock() - start) / CLOCKS_PER_SEC * 1e3;
+    if (rep == 0 || ms < best) best = ms;
+    s21_arena_free(&arena);
+  }
+  if (sum == 0) printf("%s\n", line);
+  return best;
+}
+
+int main(void) {
+  printf("%-6s %10s %10s %10s %8s\n", "format", "libc", "parsed", "compiled",
+         "speedup");
+  for (int k = 0; k < 3; k++) {
+    s21_format_t *fmt = s21_format_compile(formats[k]);
+    double libc = measure(run_libc, formats[k], fmt);
+    double parsed = measure(run_parsed, formats[k], fmt);
+    double compiled = measure(run_compiled, formats[k], fmt);
+    printf("%-6d %8.1fns %8.1fns %8.1fns %7.2fx\n", k, libc, parsed, compiled,
+           parsed / compiled);
+    s21_format_free(fmt);
+  }
+  printf("\n%-8s %10s %10s %8s\n", "parse", "libc", "s21", "speedup");
+  for (int doubles = 0; doubles < 2; doubles++) {
+    s21_size_t len;
+    char *text = number_text(doubles, &len);
+    if (text == s21_NULL) return 1;
+    parse_fn libc_fn = doubles ? libc_strtod : libc_strtoll;
+    parse_fn s21_fn = doubles ? s21_strtod : s21_strtoll_10;
+    double libc = measure_parse(libc_fn, text, len);
+    double ours = measure_parse(s21_fn, text, len);
+    printf("%-8s %6.2fGB/s %6.2fGB/s %7.2fx\n", doubles ? "strtod" : "strtoll",
+           libc, ours, ours / libc);
+    free(text);
+  }
+  double strcat_ms = measure_concat(0), builder_ms = measure_concat(1);
+  printf("\n%-8s %10s %10s %8s\n", "concat", "strcat", "builder", "speedup");
+  printf("%-8d %8.2fms %8.2fms %7.2fx\n", RECORDS, strcat_ms, builder_ms,
+         strcat_ms / builder_ms);
+  double free_ms = measure_request(0), arena_ms = measure_request(1);
+  printf("\n%-8s %10s %10s %8s\n", "request", "s21_free", "arena", "speedup");
+  printf("%-8d %8.2fms %8.2fms %7.2fx\n", RECORDS, free_ms, arena_ms,
+         free_ms / arena_ms);
+  return 0;
+}
@@ -1,7 +1,14 @@
+#define _DEFAULT_SOURCE
 #include <check.h>
+#include <errno.h>
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "../s21_string.h"
 
@@ -20,6 +27,24 @@ START_TEST(test_strlen) {
 }
 END_TEST
 
+START_TEST(test_strlen_long) {
+  static char buf[8192];
+  for (size_t i = 0; i < sizeof(buf) - 1; i++) buf[i] = (char)('a' + i % 26);
+  for (size_t off = 0; off < 64; off++) {
+    for (size_t len = 0; len < 300; len++) {
+      char keep = buf[off + len];
+      buf[off + len] = '\0';
+      ck_assert_uint_eq(strlen(buf + off), s21_strlen(buf + off));
+      buf[off + len] = keep;
+    }
+  }
+  buf[sizeof(buf) - 1] = '\0';
+  buf[5000] = (char)0x80;
+  ck_assert_uint_eq(strlen(buf + 3), s21_strlen(buf + 3));
+  ck_assert_uint_eq(strlen(buf), s21_strlen(buf));
+}
+END_TEST
+
 START_TEST(test_memset) {
   char str_21[11] = "";
   char str_31[30] = "oireub ejenrgi\n jr oi";
@@ -47,6 +72,29 @@ START_TEST(test_memset) {
 }
 END_TEST
 
+START_TEST(test_memset_pattern) {
+  static unsigned char buf1[2000], buf2[2000];
+  const unsigned char pattern[16] = "0123456789abcdef";
+  for (size_t n = 0; n < 1200; n += (n < 200) ? 1 : 43) {
+    memset(buf1, '#', sizeof(buf1));
+    memset(buf2, '#', sizeof(buf2));
+    memset(buf1 + 3, 'z', n);
+    ck_assert_ptr_eq(buf2 + 3, s21_memset(buf2 + 3, 'z', n));
+    ck_assert_mem_eq(buf1, buf2, sizeof(buf1));
+    for (size_t len = 4; len <= 16; len *= 2) {
+      for (size_t i = 0; i < n; i++) buf1[5 + i] = pattern[i % len];
+      if (len == 4)
+        s21_memset_pattern4(buf2 + 5, pattern, n);
+      else if (len == 8)
+        s21_memset_pattern8(buf2 + 5, pattern, n);
+      else
+        s21_memset_pattern16(buf2 + 5, pattern, n);
+      ck_assert_mem_eq(buf1, buf2, sizeof(buf1));
+    }
+  }
+}
+END_TEST
+
 START_TEST(test_memcmp) {
   char *strings[] = {
       "",
@@ -74,6 +122,24 @@ START_TEST(test_memcmp) {
 }
 END_TEST
 
+START_TEST(test_memcmp_long) {
+  static unsigned char buf1[1000], buf2[1000];
+  for (size_t i = 0; i < sizeof(buf1); i++) buf1[i] = buf2[i] = (char)(i * 31);
+  for (size_t n = 0; n < sizeof(buf1); n += (n < 140) ? 1 : 29) {
+    ck_assert_int_eq(0, s21_memcmp(buf1, buf2, n));
+    ck_assert_int_eq(1, s21_memeq(buf1, buf2, n));
+    for (size_t k = 0; k < n; k += (n < 40) ? 1 : 11) {
+      buf2[k] ^= 0x80;
+      ck_assert_int_eq(memcmp(buf1, buf2, n), s21_memcmp(buf1, buf2, n));
+      ck_assert_int_eq(0, s21_memeq(buf1, buf2, n));
+      buf2[k] ^= 0x80;
+    }
+  }
+  ck_assert_int_gt(s21_memcmp("\xff", "\x01", 1), 0);
+  ck_assert_int_lt(s21_memcmp("abc\x01", "abc\xfe", 4), 0);
+}
+END_TEST
+
 START_TEST(test_strcmp) {
   char *strings[] = {
       "",
@@ -166,6 +232,23 @@ START_TEST(test_strerror) {
 }
 END_TEST
 
+START_TEST(test_strerror_r) {
+  char buf[64];
+  char small[8];
+  int codes[] = {0, 1, 2, 22, N, N + 1, 1000, -1, -2147483647 - 1};
+  for (int i = 0; i < 9; i++) {
+    int known = codes[i] >= 0 && codes[i] <= N;
+    ck_assert_str_eq(strerror(codes[i]), s21_strerror(codes[i]));
+    ck_assert_int_eq(known ? 0 : EINVAL,
+                     s21_strerror_r(codes[i], buf, sizeof(buf)));
+    ck_assert_str_eq(strerror(codes[i]), buf);
+  }
+  ck_assert_int_eq(ERANGE, s21_strerror_r(2, small, sizeof(small)));
+  ck_assert_str_eq("No such", small);
+  ck_assert_int_eq(ERANGE, s21_strerror_r(2, small, 0));
+}
+END_TEST
+
 START_TEST(test_strcat) {
   char str11[10] = "6753";
   char str21[10] = "6734";
@@ -274,6 +357,29 @@ START_TEST(test_memcpy) {
 }
 END_TEST
 
+START_TEST(test_memcpy_sizes) {
+  static char src[4096], dst1[4096], dst2[4096];
+  for (size_t i = 0; i < sizeof(src); i++) src[i] = (char)(i * 7 + 3);
+  s21_size_t previous = s21_set_stream_threshold(512);
+  for (size_t n = 0; n < 1100; n += (n < 300) ? 1 : 37) {
+    for (size_t off = 0; off < 40; off += 13) {
+      memset(dst1, '#', sizeof(dst1));
+      memset(dst2, '#', sizeof(dst2));
+      memcpy(dst1 + off, src + 5, n);
+      ck_assert_ptr_eq(dst2 + off, s21_memcpy(dst2 + off, src + 5, n));
+      ck_assert_mem_eq(dst1, dst2, sizeof(dst1));
+    }
+  }
+  ck_assert_ptr_nonnull(
+      strstr(s21_memcpy_kernel_name(1 << 20),
+             strcmp(s21_simd_level(), "swar") ? "-stream" : "-loop"));
+  ck_assert_ptr_nonnull(strstr(s21_memcpy_kernel_name(8), "-tiny"));
+  s21_set_stream_threshold(previous);
+  ck_assert_ptr_eq(NULL, s21_memcpy(NULL, src, 10));
+  ck_assert_ptr_eq(dst1, s21_memcpy(dst1, NULL, 10));
+}
+END_TEST
+
 START_TEST(test_memmove) {
   char str1[30] = "1232435465";
   char str2[30] = "pwek";
@@ -293,6 +399,49 @@ START_TEST(test_memmove) {
 }
 END_TEST
 
+START_TEST(test_memmove_overlap) {
+  static char buf1[3000], buf2[3000];
+  for (size_t n = 0; n < 1100; n += (n < 300) ? 1 : 53) {
+    for (int shift = -70; shift <= 70; shift += 7) {
+      for (size_t i = 0; i < sizeof(buf1); i++) buf1[i] = buf2[i] = (char)i;
+      memmove(buf1 + 800 + shift, buf1 + 800, n);
+      ck_assert_ptr_eq(buf2 + 800 + shift,
+                       s21_memmove(buf2 + 800 + shift, buf2 + 800, n));
+      ck_assert_mem_eq(buf1, buf2, sizeof(buf1));
+    }
+  }
+}
+END_TEST
+
+// Two pages with the second one made inaccessible, so that a read past a
+// buffer placed at the end of the first page faults.
+static char *guarded_page(long *size) {
+  *size = sysconf(_SC_PAGESIZE);
+  char *page = mmap(NULL, 2 * *size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ck_assert(page != MAP_FAILED);
+  ck_assert_int_eq(mprotect(page + *size, *size, PROT_NONE), 0);
+  return page;
+}
+
+START_TEST(test_memchr_guard) {
+  long size;
+  char *page = guarded_page(&size);
+  memset(page, 'x', size);
+  for (int len = 1; len <= 300; len++) {
+    char *s = page + size - len;
+    s[len - 1] = '\0';
+    ck_assert_ptr_eq(s21_memchr(s, '\0', len + 100), s + len - 1);
+    if (len > 1) ck_assert_ptr_eq(s21_memchr(s, 'x', len + 100), s);
+    ck_assert_ptr_null(s21_memchr(s, 'y', len));
+    s[len - 1] = 'x';
+  }
+  strcpy(page + size - 4, "abc");
+  ck_assert_ptr_eq(s21_memchr(page + size - 4, 0, 100), page + size - 1);
+  munmap(page, 2 * size);
+}
+END_TEST
+
 START_TEST(test_memchr) {
   char str1[30] = "1232435465";
   char str2[30] = "pwek";
@@ -317,6 +466,33 @@ START_TEST(test_memchr) {
 }
 END_TEST
 
+START_TEST(test_memchr_family) {
+  static char buf[3000];
+  memset(buf, 'x', sizeof(buf));
+  buf[1500] = '\n';
+  buf[2100] = '\r';
+  buf[2500] = '\n';
+  ck_assert_ptr_eq(buf + 1500, s21_memchr(buf, '\n', sizeof(buf)));
+  ck_assert_ptr_eq(NULL, s21_memchr(buf, '\n', 1500));
+  ck_assert_ptr_eq(buf + 2500, s21_memrchr(buf, '\n', sizeof(buf)));
+  ck_assert_ptr_eq(buf + 1500, s21_memrchr(buf, '\n', 2500));
+  ck_assert_ptr_eq(NULL, s21_memrchr(buf + 1501, '\n', 999));
+  ck_assert_ptr_eq(buf + 1500, s21_memchr2(buf, '\r', '\n', sizeof(buf)));
+  ck_assert_ptr_eq(buf + 2100, s21_memchr2(buf + 1501, '\r', '\n', 1499));
+  ck_assert_ptr_eq(NULL, s21_memchr2(buf, '\r', '\n', 1500));
+  ck_assert_ptr_eq(buf + 2100,
+                   s21_memchr3(buf + 1501, ',', '\r', '\n', 1499));
+  ck_assert_ptr_eq(NULL, s21_memchr3(buf, ',', '\r', '\n', 1500));
+  for (size_t n = 0; n < 200; n++) {
+    ck_assert_ptr_eq(memchr(buf + 1400, '\n', n),
+                     s21_memchr(buf + 1400, '\n', n));
+    ck_assert_ptr_eq(n > 100 ? buf + 1500 : NULL,
+                     s21_memrchr(buf + 1400, '\n', n));
+  }
+  ck_assert_ptr_eq(NULL, s21_memrchr(s21_NULL, 'a', 0));
+}
+END_TEST
+
 START_TEST(test_strchr) {
   char str_1[10] = "\0";
   char str_2[50] = "Per aspera ad astra";
@@ -431,6 +607,166 @@ START_TEST(test_strpbrk) {
 }
 END_TEST
 
+START_TEST(test_span_long) {
+  static char buf[2000];
+  char *sets[] = {"ab", ":;,\r\n\t", "\x80\xff\x01",
+                  "abcdefghijklmnopqrstuvwxyz"};
+  for (size_t k = 0; k < sizeof(sets) / sizeof(*sets); k++) {
+    for (size_t len = 0; len < 600; len += 7) {
+      for (size_t i = 0; i < len; i++) buf[i] = sets[k][i % strlen(sets[k])];
+      buf[len] = '\0';
+      ck_assert_uint_eq(strspn(buf, sets[k]), s21_strspn(buf, sets[k]));
+      ck_assert_uint_eq(strcspn(buf, "Q\xfe"), s21_strcspn(buf, "Q\xfe"));
+      ck_assert_ptr_eq(strpbrk(buf, "Q\xfe"), s21_strpbrk(buf, "Q\xfe"));
+      if (len > 3) {
+        buf[len - 3] = '\xfe';
+        ck_assert_uint_eq(strspn(buf, sets[k]), s21_strspn(buf, sets[k]));
+        ck_assert_uint_eq(strcspn(buf, "Q\xfe"), s21_strcspn(buf, "Q\xfe"));
+        ck_assert_ptr_eq(strpbrk(buf, "Q\xfe"), s21_strpbrk(buf, "Q\xfe"));
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_strstr_long) {
+  static char haystack[12000], needle[4000];
+  s21_memset(haystack, 'a', sizeof(haystack) - 1);
+  s21_memset(needle, 'a', sizeof(needle) - 1);
+  needle[sizeof(needle) - 2] = 'b';
+  ck_assert_ptr_eq(strstr(haystack, needle), s21_strstr(haystack, needle));
+  haystack[9000] = 'b';
+  ck_assert_ptr_eq(strstr(haystack, needle), s21_strstr(haystack, needle));
+  ck_assert_ptr_eq(haystack + 9000 - 3998, s21_strstr(haystack, needle));
+  for (int i = 0; i < 11999; i++) haystack[i] = "abcab"[i % 5];
+  ck_assert_ptr_eq(strstr(haystack, "cabcaba"),
+                   s21_strstr(haystack, "cabcaba"));
+  ck_assert_ptr_eq(strstr(haystack, "abcabb"), s21_strstr(haystack, "abcabb"));
+  ck_assert_ptr_eq(strstr(haystack + 7, "bab"),
+                   s21_strstr(haystack + 7, "bab"));
+  // Matches across the blocks the haystack is read in.
+  s21_memset(haystack, 'a', sizeof(haystack) - 1);
+  for (int at = 250; at < 11990; at += 251) {
+    memcpy(haystack + at, "xyz", 3);
+    ck_assert_ptr_eq(s21_strstr(haystack, "axyza"), haystack + at - 1);
+    memcpy(haystack + at, "aaa", 3);
+  }
+}
+END_TEST
+
+START_TEST(test_strstr_guard) {
+  long size;
+  char *page = guarded_page(&size);
+  memset(page, 'x', size);
+  // The haystack has no terminator before the guard page; a match near
+  // its start must be found without looking for one.
+  memcpy(page + 10, "needle", 6);
+  ck_assert_ptr_eq(s21_strstr(page, "needle"), page + 10);
+  ck_assert_ptr_eq(s21_strstr(page, "x"), page);
+  page[size - 1] = '\0';
+  ck_assert_ptr_null(s21_strstr(page + size - 300, "needle"));
+  ck_assert_ptr_eq(s21_strstr(page + size - 4, "xx"), page + size - 4);
+  munmap(page, 2 * size);
+}
+END_TEST
+
+START_TEST(test_searcher) {
+  char text[] = "GET /index.html 200\nGET /favicon.ico 404\nPOST /login 302\n";
+  s21_size_t len = sizeof(text) - 1;
+  char *needles[] = {"", "\n", "404", "POST /login", "GET /missing",
+                     "/favicon.ico 404\nPOST /login 302\n"};
+  for (int i = 0; i < 6; i++) {
+    s21_searcher_t *searcher = s21_searcher_compile(needles[i]);
+    ck_assert_ptr_nonnull(searcher);
+    ck_assert_ptr_eq(strstr(text, needles[i]),
+                     s21_searcher_find(searcher, text, len));
+    if (i > 0) ck_assert_ptr_eq(s21_NULL, s21_searcher_find(searcher, text, 2));
+    s21_searcher_free(searcher);
+  }
+  s21_searcher_t *searcher = s21_searcher_compile("x\n");
+  ck_assert_str_eq("pair", s21_searcher_algorithm(searcher));
+  text[5] = '\0';
+  ck_assert_ptr_eq(s21_NULL, s21_searcher_find(searcher, text, len));
+  text[len - 2] = 'x';
+  ck_assert_ptr_eq(text + len - 2, s21_searcher_find(searcher, text, len));
+  s21_searcher_free(searcher);
+  ck_assert_ptr_eq(s21_NULL, s21_searcher_compile(s21_NULL));
+}
+END_TEST
+
+static int collect_match(s21_size_t id, s21_size_t offset, void *ctx) {
+  s21_size_t *hits = ctx;
+  hits[id] += offset + 1;
+  return 0;
+}
+
+static int stop_match(s21_size_t id, s21_size_t offset, void *ctx) {
+  (void)id;
+  (void)offset;
+  (void)ctx;
+  return 1;
+}
+
+START_TEST(test_multisearch) {
+  const char text[] = "she sells sea shells by the sea shore";
+  const char *few[] = {"he", "she", "sea", "hers", "", "e s"};
+  static char many_buf[40][8];
+  const char *many[40];
+  s21_size_t hits[40] = {0}, expected[40] = {0};
+  s21_multisearch_t *ms = s21_multisearch_compile(few, 6);
+  ck_assert_ptr_nonnull(ms);
+  ck_assert_uint_eq(9, s21_multisearch_scan(ms, text, strlen(text),
+                                            collect_match, hits));
+  ck_assert_uint_eq(2 + 16 + 26, hits[0]);
+  ck_assert_uint_eq(1 + 15, hits[1]);
+  ck_assert_uint_eq(11 + 29, hits[2]);
+  ck_assert_uint_eq(0, hits[3] + hits[4]);
+  ck_assert_uint_eq(3 + 27, hits[5]);
+  ck_assert_uint_eq(1, s21_multisearch_scan(ms, text, 9, stop_match, s21_NULL));
+  s21_multisearch_free(ms);
+
+  for (int i = 0; i < 40; i++) {
+    sprintf(many_buf[i], "%c%c", 'a' + i % 26, 'a' + i % 7);
+    many[i] = many_buf[i];
+    for (const char *p = text; (p = strstr(p, many[i])) != s21_NULL; p++) {
+      expected[i] += (s21_size_t)(p - text) + 1;
+    }
+  }
+  s21_memset(hits, 0, sizeof(hits));
+  ms = s21_multisearch_compile(many, 40);
+  ck_assert_str_eq("aho-corasick", s21_multisearch_algorithm(ms));
+  s21_multisearch_scan(ms, text, strlen(text), collect_match, hits);
+  ck_assert_mem_eq(expected, hits, sizeof(hits));
+  s21_multisearch_free(ms);
+  ck_assert_ptr_eq(s21_NULL, s21_multisearch_compile(s21_NULL, 1));
+}
+END_TEST
+
+START_TEST(test_split) {
+  const char record[] = "id,name,,price;qty,\0x,";
+  const char *fields[] = {"id", "name", "", "price", "qty", "\0x", ""};
+  s21_span_t spans[8];
+  static char line[1000];
+  static s21_span_t many[200];
+  ck_assert_uint_eq(7, s21_split(record, sizeof(record) - 1, ",;", spans, 8));
+  for (int i = 0; i < 7; i++) {
+    ck_assert_uint_eq(i == 5 ? 2 : strlen(fields[i]), spans[i].len);
+    ck_assert_mem_eq(fields[i], spans[i].ptr, spans[i].len);
+  }
+  ck_assert_uint_eq(7, s21_split(record, sizeof(record) - 1, ",;", spans, 2));
+  ck_assert_uint_eq(7,
+                    s21_split(record, sizeof(record) - 1, ",;", s21_NULL, 0));
+  ck_assert_uint_eq(1, s21_split(record, 0, ",", spans, 8));
+  ck_assert_uint_eq(0, spans[0].len);
+  for (int i = 0; i < 999; i++) line[i] = i % 7 == 6 ? '\t' : 'a' + i % 7;
+  ck_assert_uint_eq(143, s21_split(line, 999, "\t", many, 200));
+  for (int i = 0; i < 143; i++) {
+    ck_assert_ptr_eq(line + i * 7, many[i].ptr);
+    ck_assert_uint_eq(i == 142 ? 5 : 6, many[i].len);
+  }
+}
+END_TEST
+
 START_TEST(test_strtok) {
   char *p = NULL;
   char *p2 = s21_NULL;
@@ -487,6 +823,56 @@ START_TEST(test_strtok) {
 }
 END_TEST
 
+START_TEST(test_strtok_r) {
+  char str1[50] = "a,b;;c,,;d";
+  char str2[50] = "a,b;;c,,;d";
+  char *save2 = s21_NULL;
+  char *p = strtok(str1, ",;");
+  char *p2 = s21_strtok_r(str2, ",;", &save2);
+  char *outer = s21_NULL, *inner = s21_NULL;
+  char nested[] = "k1=v1&k2=v2";
+  while (p != NULL) {
+    ck_assert_ptr_eq(p - str1 + str2, p2);
+    p = strtok(NULL, ",;");
+    p2 = s21_strtok_r(s21_NULL, ",;", &save2);
+  }
+  ck_assert_ptr_eq(s21_NULL, p2);
+  ck_assert_ptr_eq(s21_NULL, s21_strtok_r(s21_NULL, ",;", &save2));
+  for (char *pair = s21_strtok_r(nested, "&", &outer); pair;
+       pair = s21_strtok_r(s21_NULL, "&", &outer)) {
+    ck_assert_int_eq('k', *s21_strtok_r(pair, "=", &inner));
+    ck_assert_int_eq('v', *s21_strtok_r(s21_NULL, "=", &inner));
+  }
+}
+END_TEST
+
+START_TEST(test_tokenizer) {
+  const char text[] = "  GET /a\0b HTTP/1.1\r\n";
+  const char *words[] = {"GET", "/a\0b", "HTTP/1.1"};
+  s21_size_t lens[] = {3, 4, 8};
+  s21_tokenizer_t tok;
+  s21_span_t span;
+  static char line[300];
+  int count = 0;
+  s21_tokenizer_init(&tok, text, sizeof(text) - 1, " \r\n");
+  for (int i = 0; i < 3; i++) {
+    ck_assert_int_eq(1, s21_tokenizer_next(&tok, &span));
+    ck_assert_uint_eq(lens[i], span.len);
+    ck_assert_mem_eq(words[i], span.ptr, lens[i]);
+  }
+  ck_assert_int_eq(0, s21_tokenizer_next(&tok, &span));
+  ck_assert_int_eq(0, s21_tokenizer_next(&tok, &span));
+  for (int i = 0; i < 299; i++) line[i] = i % 10 == 9 ? ',' : 'x';
+  s21_tokenizer_init(&tok, line, 299, ",");
+  while (s21_tokenizer_next(&tok, &span)) {
+    ck_assert_ptr_eq(line + count * 10, span.ptr);
+    ck_assert_uint_eq(9, span.len);
+    count++;
+  }
+  ck_assert_int_eq(30, count);
+}
+END_TEST
+
 START_TEST(test_toupper) {
   ck_assert_str_eq("3ME-IMMNU-KINYBVYNIB-JUTCGKHYFUIJ",
                    s21_to_upper("3me-imMNU-kinybvyNIB-jUtCgKHyfuiJ"));
@@ -533,6 +919,420 @@ START_TEST(test_trim) {
 }
 END_TEST
 
+typedef struct {
+  int allocs;
+  int frees;
+} alloc_count;
+
+static void *count_alloc(s21_size_t size, void *ctx) {
+  ((alloc_count *)ctx)->allocs++;
+  return malloc(size);
+}
+
+static void *count_realloc(void *ptr, s21_size_t size, void *ctx) {
+  if (ptr == NULL) ((alloc_count *)ctx)->allocs++;
+  return realloc(ptr, size);
+}
+
+static void count_free(void *ptr, void *ctx) {
+  ((alloc_count *)ctx)->frees++;
+  free(ptr);
+}
+
+START_TEST(test_allocator) {
+  alloc_count global = {0, 0}, local = {0, 0};
+  s21_set_allocator(count_alloc, count_realloc, count_free, &global);
+  char *upper = s21_to_upper("abc");
+  char *inserted = s21_insert("abc", "XY", 1);
+  char *trimmed = s21_trim("  abc  ", NULL);
+  char *formatted = NULL;
+  ck_assert_int_eq(s21_asprintf(&formatted, "%d-%s", 42, "x"), 4);
+  ck_assert_str_eq(upper, "ABC");
+  ck_assert_str_eq(inserted, "aXYbc");
+  ck_assert_str_eq(trimmed, "abc");
+  ck_assert_str_eq(formatted, "42-x");
+  ck_assert_int_eq(global.allocs, 4);
+  s21_free(upper);
+  s21_free(inserted);
+  s21_free(trimmed);
+  s21_free(formatted);
+  ck_assert_int_eq(global.frees, 4);
+  s21_set_thread_allocator(count_alloc, count_realloc, count_free, &local);
+  s21_builder b;
+  s21_builder_init(&b);
+  s21_builder_append_cstr(&b, "a longer text than fits");
+  s21_str s;
+  s21_str_from(&s, "a longer text than fits inline");
+  s21_str_free(&s);
+  s21_free(s21_builder_finish(&b, NULL));
+  ck_assert_int_eq(global.allocs, 4);
+  ck_assert_int_eq(local.allocs, 2);
+  ck_assert_int_eq(local.frees, 2);
+  s21_set_thread_allocator(NULL, NULL, NULL, NULL);
+  s21_set_allocator(NULL, NULL, NULL, NULL);
+  upper = s21_to_upper("abc");
+  free(upper);
+  ck_assert_int_eq(global.allocs + local.allocs, 6);
+}
+END_TEST
+
+START_TEST(test_arena) {
+  alloc_count count = {0, 0};
+  s21_arena arena;
+  s21_set_allocator(count_alloc, count_realloc, count_free, &count);
+  s21_arena_init(&arena, 256);
+  char long_text[1024];
+  memset(long_text, 'x', sizeof(long_text) - 1);
+  long_text[sizeof(long_text) - 1] = '\0';
+  for (int round = 0; round < 3; round++) {
+    char *upper = s21_to_upper_arena(&arena, "Hello, World");
+    char *lower = s21_to_lower_arena(&arena, "Hello, World");
+    char *inserted = s21_insert_arena(&arena, "abc", "XY", 1);
+    char *trimmed = s21_trim_arena(&arena, " \t abc \n", NULL);
+    char *formatted = NULL, *big = NULL;
+    ck_assert_int_eq(s21_asprintf_arena(&arena, &formatted, "%d-%s", 42, "x"),
+                     4);
+    ck_assert_int_eq(s21_asprintf_arena(&arena, &big, "%s!", long_text),
+                     1024);
+    ck_assert_str_eq(upper, "HELLO, WORLD");
+    ck_assert_str_eq(lower, "hello, world");
+    ck_assert_str_eq(inserted, "aXYbc");
+    ck_assert_str_eq(trimmed, "abc");
+    ck_assert_str_eq(formatted, "42-x");
+    ck_assert_int_eq(strncmp(big, long_text, 1023), 0);
+    ck_assert_str_eq(big + 1023, "!");
+    ck_assert_int_eq((int)((uintptr_t)lower % _Alignof(max_align_t)), 0);
+    ck_assert_ptr_null(s21_insert_arena(&arena, "abc", "XY", 4));
+    s21_arena_reset(&arena);
+  }
+  // The chunks of the first round are reused by the next ones.
+  ck_assert_int_eq(count.allocs, 2);
+  ck_assert_int_eq(count.frees, 0);
+  s21_arena_free(&arena);
+  ck_assert_int_eq(count.frees, 2);
+  s21_set_allocator(NULL, NULL, NULL, NULL);
+  char *upper = s21_to_upper(long_text);
+  ck_assert_int_eq(upper[1022], 'X');
+  s21_free(upper);
+}
+END_TEST
+
+START_TEST(test_str) {
+  s21_str s, t;
+  char expected[512] = "";
+  ck_assert_uint_eq(sizeof(s21_str), 4 * sizeof(s21_size_t));
+  ck_assert_int_eq(s21_str_from(&s, "short key"), 0);
+  ck_assert_uint_eq(s21_str_len(&s), 9);
+  ck_assert_uint_eq(s21_str_cap(&s), S21_STR_INLINE);
+  ck_assert_int_eq(s21_str_from(&t, "0123456789"), 0);
+  strcpy(expected, "short key");
+  for (int i = 0; i < 30; i++) {
+    ck_assert_int_eq(s21_str_cat(&s, &t), 0);
+    strcat(expected, "0123456789");
+    ck_assert_uint_eq(s21_str_len(&s), strlen(expected));
+    ck_assert_str_eq(s21_str_cstr(&s), expected);
+  }
+  ck_assert(s21_str_cap(&s) >= 309);
+  ck_assert_uint_eq(s21_str_find(&s, &t, 0), 9);
+  ck_assert_uint_eq(s21_str_find(&s, &t, 10), 19);
+  ck_assert_int_eq(s21_str_assign(&s, " \t Hello, World \n", 17), 0);
+  s21_str_trim(&s, s21_NULL);
+  ck_assert_str_eq(s21_str_cstr(&s), "Hello, World");
+  ck_assert_int_eq(s21_str_insert_cstr(&s, 5, " there"), 0);
+  ck_assert_str_eq(s21_str_cstr(&s), "Hello there, World");
+  ck_assert_int_eq(s21_str_insert(&s, 0, s21_str_cstr(&s) + 6, 5), 0);
+  ck_assert_str_eq(s21_str_cstr(&s), "thereHello there, World");
+  ck_assert_int_eq(s21_str_insert_cstr(&s, 100, "x"), -1);
+  s21_str_to_upper(&s);
+  ck_assert_str_eq(s21_str_cstr(&s), "THEREHELLO THERE, WORLD");
+  s21_str_to_lower(&s);
+  ck_assert_str_eq(s21_str_cstr(&s), "therehello there, world");
+  ck_assert_int_eq(s21_str_cat(&s, &s), 0);
+  ck_assert_str_eq(s21_str_cstr(&s),
+                   "therehello there, worldtherehello there, world");
+  s21_str_trim(&s, "dlrow, t");
+  ck_assert_str_eq(s21_str_cstr(&s), "herehello there, worldtherehello there");
+  ck_assert_int_eq(s21_str_assign(&t, "a\0b", 3), 0);
+  ck_assert_uint_eq(s21_str_len(&t), 3);
+  ck_assert_int_eq(s21_str_assign(&s, "a\0c", 3), 0);
+  ck_assert_int_lt(s21_str_cmp(&t, &s), 0);
+  ck_assert_int_eq(s21_str_eq(&t, &s), 0);
+  s21_str_free(&s);
+  ck_assert_uint_eq(s21_str_len(&s), 0);
+  ck_assert_int_gt(s21_str_cmp(&t, &s), 0);
+  s21_str_free(&t);
+}
+END_TEST
+
+START_TEST(test_u64toa) {
+  char str1[32], str2[32];
+  unsigned long long value = 0;
+  for (int i = 0; i < 2000; i++) {
+    ck_assert_int_eq(sprintf(str1, "%llu", value), s21_u64toa(value, str2));
+    ck_assert_str_eq(str1, str2);
+    ck_assert_int_eq(sprintf(str1, "%lld", (long long)value),
+                     s21_i64toa((long long)value, str2));
+    ck_assert_str_eq(str1, str2);
+    ck_assert_int_eq(sprintf(str1, "%llx", value),
+                     s21_u64toa_hex(value, str2, 0));
+    ck_assert_str_eq(str1, str2);
+    ck_assert_int_eq(sprintf(str1, "%llX", value),
+                     s21_u64toa_hex(value, str2, 1));
+    ck_assert_str_eq(str1, str2);
+    // Walks every digit count, and the values around each power of ten.
+    value = i % 3 == 0 ? value * 10 + 9 : i % 3 == 1 ? value + 1 : value - 1;
+    if (i % 60 == 59) value = (value * 6364136223846793005ULL) >> (i % 64);
+  }
+  ck_assert_int_eq(s21_i64toa(LLONG_MIN, str2), 20);
+  ck_assert_str_eq(str2, "-9223372036854775808");
+  ck_assert_int_eq(s21_u64toa(ULLONG_MAX, str2), 20);
+  ck_assert_str_eq(str2, "18446744073709551615");
+  ck_assert_int_eq(s21_u64toa(0, str2), 1);
+  ck_assert_str_eq(str2, "0");
+}
+END_TEST
+
+START_TEST(test_builder) {
+  s21_builder b;
+  char expected[16384] = "", tmp[64];
+  s21_size_t len = 0;
+  s21_builder_init(&b);
+  for (int i = 0; i < 200; i++) {
+    s21_builder_append_cstr(&b, "item ");
+    s21_builder_append_int(&b, -i * 1000003LL);
+    s21_builder_append_char(&b, ':');
+    s21_builder_append_uint(&b, 18446744073709551615ULL - i);
+    ck_assert_int_eq(s21_builder_printf(&b, " [%5.2f|%-4s]", i / 8.0, "ab"),
+                     13);
+    s21_builder_append(&b, "\n--", 1);
+    sprintf(tmp, "item %lld:%llu [%5.2f|%-4s]\n", -i * 1000003LL,
+            18446744073709551615ULL - i, i / 8.0, "ab");
+    strcat(expected, tmp);
+    ck_assert_uint_eq(s21_builder_len(&b), strlen(expected));
+  }
+  char *str = s21_builder_finish(&b, &len);
+  ck_assert_ptr_nonnull(str);
+  ck_assert_uint_eq(len, strlen(expected));
+  ck_assert_str_eq(str, expected);
+  free(str);
+  ck_assert_uint_eq(s21_builder_len(&b), 0);
+  ck_assert_int_eq(s21_builder_reserve(&b, 100), 0);
+  str = s21_builder_finish(&b, s21_NULL);
+  ck_assert_str_eq(str, "");
+  free(str);
+  s21_builder_append_cstr(&b, "dropped");
+  s21_builder_free(&b);
+  ck_assert_uint_eq(s21_builder_len(&b), 0);
+}
+END_TEST
+
+START_TEST(test_float_exact) {
+  char str1[2048], str2[2048];
+  const char *formats[] = {"%f", "%.0f",  "%.20f", "%e",    "%.0e", "%.16e",
+                           "%g", "%.17g", "%#g",   "%+.3G", "%F",   "%-12.4E"};
+  // Halfway cases, values past the range of long long and subnormals.
+  double values[] = {0.0,   -0.0,     0.5,        1.5,     2.5,      0.125,
+                     1e-7,  123456.5, 9.999e9,    1e22,    1e23,     9.2e18,
+                     1e308, 5e-324,   -1234.5678, 1.0 / 3, INFINITY, -NAN};
+  for (s21_size_t k = 0; k < sizeof(formats) / sizeof(*formats); k++) {
+    for (s21_size_t i = 0; i < sizeof(values) / sizeof(*values); i++) {
+      ck_assert_int_eq(sprintf(str1, formats[k], values[i]),
+                       s21_sprintf(str2, formats[k], values[i]));
+      ck_assert_str_eq(str1, str2);
+    }
+  }
+  ck_assert_int_eq(sprintf(str1, "%.60Lf", 1.0L / 3),
+                   s21_sprintf(str2, "%.60Lf", 1.0L / 3));
+  ck_assert_str_eq(str1, str2);
+  // Long double expansions run to thousands of digits, all of them exact.
+  static char long1[20000], long2[20000];
+  const char *long_formats[] = {"%Lf", "%.900Le", "%.5000Lf", "%.12000Le"};
+  long double long_values[] = {LDBL_MAX, LDBL_MIN, 1e4000L};
+  for (int i = 0; i < 3; i++) {
+    for (int k = 0; k < 4; k++) {
+      ck_assert_int_eq(
+          snprintf(long1, sizeof(long1), long_formats[k], long_values[i]),
+          s21_snprintf(long2, sizeof(long2), long_formats[k], long_values[i]));
+      ck_assert_str_eq(long1, long2);
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_dtoa) {
+  char str[64];
+  double values[] = {0.1, 0.3, 1.0 / 3, 5e-324, 1.7976931348623157e308,
+                     123456789012345678.0, 2.5e-5, -42.0};
+  const char *expected[] = {"0.1",
+                            "0.3",
+                            "0.3333333333333333",
+                            "5e-324",
+                            "1.7976931348623157e+308",
+                            "1.2345678901234568e+17",
+                            "2.5e-05",
+                            "-42"};
+  for (int i = 0; i < 8; i++) {
+    ck_assert_int_eq(s21_dtoa(values[i], str), strlen(expected[i]));
+    ck_assert_str_eq(str, expected[i]);
+    ck_assert(strtod(str, NULL) == values[i]);
+  }
+  ck_assert_int_eq(s21_sprintf(str, "[%8r|%-6R|%r]", 1e100, 1e-100, 0.0), 19);
+  ck_assert_str_eq(str, "[  1e+100|1E-100|0]");
+  s21_sprintf(str, "%.3r|%.3r|%.20r|%.0r", 1.0 / 3, 123456.0, 0.1, 0.75);
+  ck_assert_str_eq(str, "0.333|1.23e+05|0.1|0.8");
+#if LDBL_MANT_DIG == 64
+  long double longs[] = {0.1L, 1.0L / 3, LDBL_MAX, LDBL_TRUE_MIN, 9.5L};
+  const char *long_expected[] = {"0.1", "0.33333333333333333334",
+                                 "1.189731495357231765e+4932", "4e-4951",
+                                 "9.5"};
+  for (int i = 0; i < 5; i++) {
+    s21_sprintf(str, "%Lr", longs[i]);
+    ck_assert_str_eq(str, long_expected[i]);
+    ck_assert(strtold(str, NULL) == longs[i]);
+  }
+  s21_sprintf(str, "%.3Lr", 1.0L / 3);
+  ck_assert_str_eq(str, "0.333");
+#endif
+}
+END_TEST
+
+START_TEST(test_strtoll) {
+  const char *strs[] = {"0",
+                        "  -42abc",
+                        "+12345678901234567",
+                        "9223372036854775807",
+                        "9223372036854775808",
+                        "-9223372036854775808",
+                        "-99999999999999999999",
+                        "18446744073709551616",
+                        "0x1fz",
+                        "0xz",
+                        "0777",
+                        "  zzz",
+                        "000000000000000000000000012"};
+  int bases[] = {0, 10, 16, 8, 36};
+  for (int i = 0; i < 13; i++) {
+    for (int j = 0; j < 5; j++) {
+      char *end1, *end2;
+      errno = 0;
+      long long a = strtoll(strs[i], &end1, bases[j]);
+      int errno1 = errno;
+      errno = 0;
+      ck_assert_int_eq(s21_strtoll(strs[i], &end2, bases[j]), a);
+      ck_assert_int_eq(errno, errno1);
+      ck_assert_ptr_eq(end2, end1);
+      errno = 0;
+      unsigned long long b = strtoull(strs[i], &end1, bases[j]);
+      errno1 = errno;
+      errno = 0;
+      ck_assert_uint_eq(s21_strtoull(strs[i], &end2, bases[j]), b);
+      ck_assert_int_eq(errno, errno1);
+      ck_assert_ptr_eq(end2, end1);
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_strtod) {
+  const char *strs[] = {"0.1",
+                        "  -1.5e10xyz",
+                        "123456789012345678901234567890",
+                        "9007199254740993",
+                        "2.2250738585072011e-308",
+                        "4.9406564584124654e-324",
+                        "2.4703282292062328e-324",
+                        "1e-400",
+                        "1.8e308",
+                        "0x1.8p3",
+                        "0x1p-1075",
+                        "-Infinity",
+                        "nan(123)",
+                        ".e5",
+                        "1e+",
+                        "-",
+                        "-e5",
+                        "-0x",
+                        "1.00000000000000011102230246251565404236316680908203"
+                        "125"};
+  for (int i = 0; i < 19; i++) {
+    char *end1, *end2;
+    errno = 0;
+    double a = strtod(strs[i], &end1);
+    int errno1 = errno;
+    errno = 0;
+    double b = s21_strtod(strs[i], &end2);
+    ck_assert(memcmp(&a, &b, sizeof(a)) == 0 || (a != a && b != b));
+    ck_assert_int_eq(errno, errno1);
+    ck_assert_ptr_eq(end2, end1);
+  }
+}
+END_TEST
+
+START_TEST(test_sscanf) {
+  int a1 = 0, a2 = 0, b1 = 0, b2 = 0, n1 = 0, n2 = 0;
+  long long ll1 = 0, ll2 = 0;
+  unsigned u1 = 0, u2 = 0;
+  short h1 = 0, h2 = 0;
+  double d1 = 0, d2 = 0;
+  float f1 = 0, f2 = 0;
+  char s1[16] = "", s2[16] = "", w1[16] = "", w2[16] = "";
+  char c1[4] = "", c2[4] = "";
+  void *p1 = NULL, *p2 = NULL;
+  const char *str = " -17 0x1F  word 3.25e2 abc,def 0777 12 1e-3 zz 0x10";
+  const char *format = "%d %i %5s %lf %[a-z],%*s %o %hd%n %f %2c %p";
+  ck_assert_int_eq(
+      s21_sscanf(str, format, &a1, &b1, s1, &d1, w1, &u1, &h1, &n1, &f1, c1,
+                 &p1),
+      sscanf(str, format, &a2, &b2, s2, &d2, w2, &u2, &h2, &n2, &f2, c2, &p2));
+  ck_assert_int_eq(a1, a2);
+  ck_assert_int_eq(b1, b2);
+  ck_assert_str_eq(s1, s2);
+  ck_assert_str_eq(w1, w2);
+  ck_assert(d1 == d2);
+  ck_assert_uint_eq(u1, u2);
+  ck_assert_int_eq(h1, h2);
+  ck_assert_int_eq(n1, n2);
+  ck_assert(f1 == f2);
+  ck_assert(memcmp(c1, c2, 2) == 0);
+  ck_assert_ptr_eq(p1, p2);
+  ck_assert_int_eq(s21_sscanf("12345678901234567890", "%lld", &ll1),
+                   sscanf("12345678901234567890", "%lld", &ll2));
+  ck_assert_int_eq(ll1, ll2);
+  ck_assert_int_eq(s21_sscanf("  ", "%d", &a1), EOF);
+  ck_assert_int_eq(s21_sscanf("7 x", "%d %d", &a1, &b1), 1);
+  ck_assert_int_eq(s21_sscanf("]]a-b", "%[]a-]", s1), 1);
+  ck_assert_str_eq(s1, "]]a-");
+  ck_assert_int_eq(s21_sscanf("100%", "%d%%", &a1), 1);
+  // Widths longer than any field buffer still cut the field.
+  char zeros[600];
+  memset(zeros, '0', 530);
+  strcpy(zeros + 530, "7");
+  ck_assert_int_eq(s21_sscanf(zeros + 460, "%64d%d", &a1, &b1), 2);
+  ck_assert_int_eq(a1, 0);
+  ck_assert_int_eq(b1, 7);
+  ck_assert_int_eq(s21_sscanf(zeros, "%520lf%lf", &d1, &d2), 2);
+  ck_assert(d1 == 0.0 && d2 == 7.0);
+  // %Lf rounds to the long double, not through a double.
+  const char *longs[] = {
+      "0.1",
+      "3.14159265358979323846264338327950288",
+      "1.18973149535723176502e4932",
+      "1e4933",
+      "3.6e-4951",
+      "1.0000000000000000000542101086242752217003726400434970855712890625",
+      "1.00000000000000000005421010862427522170037264004349708557128906251",
+      "0x1.0000000000000008p0",
+      "0x1.00000000000000081p0",
+      "-0x1.8p-16446"};
+  for (int i = 0; i < 10; i++) {
+    long double x1 = 0, x2 = 0;
+    ck_assert_int_eq(s21_sscanf(longs[i], "%Lf", &x1),
+                     sscanf(longs[i], "%Lf", &x2));
+    ck_assert(x1 == x2);
+  }
+}
+END_TEST
+
 START_TEST(test_simple_sprintf) {
   char str1[1024] = {'\0'};
   char str2[1024] = {'\0'};
@@ -777,21 +1577,251 @@ START_TEST(test_part2_sprintf) {
 }
 END_TEST
 
+START_TEST(test_sprintf_precision_guard) {
+  long size;
+  char *page = guarded_page(&size), buf[256];
+  for (int len = 0; len < 80; len++) {
+    char *s = page + size - len - 1;
+    memset(s, 'a', len);
+    s[len] = '\0';
+    ck_assert_int_eq(s21_snprintf(buf, sizeof(buf), "[%.100s]", s), len + 2);
+    ck_assert_int_eq((int)strlen(buf), len + 2);
+  }
+  strcpy(page + size - 4, "abc");
+  s21_snprintf(buf, 200, "%.100s", page + size - 4);
+  ck_assert_str_eq(buf, "abc");
+  munmap(page, 2 * size);
+}
+END_TEST
+
+START_TEST(test_sprintf_fields) {
+  const char *formats[] = {"%#.0o|%#o|%#5x|%#X", "%05.2d|%-05d|%+u|% d",
+                           "%0*d|%-*d|%.*d|%.*d", "%hhd|%hu|%lx|%llo"};
+  const long long values[] = {0, -1, 255, 123456789, -7, 1LL << 40};
+  char str1[256], str2[256];
+  for (int f = 0; f < 4; f++) {
+    for (int v = 0; v < 6; v++) {
+      long long x = values[v];
+      int n1, n2;
+      if (f == 2) {
+        n1 = sprintf(str1, formats[f], 8, (int)x, 8, (int)x, 5, (int)x, -3,
+                     (int)x);
+        n2 = s21_sprintf(str2, formats[f], 8, (int)x, 8, (int)x, 5, (int)x,
+                         -3, (int)x);
+      } else if (f == 3) {
+        n1 = sprintf(str1, formats[f], (int)x, (int)x, (long)x, x);
+        n2 = s21_sprintf(str2, formats[f], (int)x, (int)x, (long)x, x);
+      } else {
+        n1 = sprintf(str1, formats[f], (int)x, (int)x, (int)x, (int)x);
+        n2 = s21_sprintf(str2, formats[f], (int)x, (int)x, (int)x, (int)x);
+      }
+      ck_assert_int_eq(n1, n2);
+      ck_assert_str_eq(str1, str2);
+    }
+  }
+  long long count = 0;
+  signed char small = 0;
+  ck_assert_int_eq(s21_sprintf(str2, "%s|%.3s%lln|%-4c|%hhn", "abc",
+                               "abcdef", &count, 'z', &small),
+                   13);
+  ck_assert_str_eq(str2, "abc|abc|z   |");
+  ck_assert_int_eq(count, 7);
+  ck_assert_int_eq(small, 13);
+  ck_assert_int_eq(s21_sprintf(str2, "%5%|%y"), 4);
+  ck_assert_str_eq(str2, "%|%y");
+}
+END_TEST
+
+START_TEST(test_format_compile) {
+  const char *format = "%s [%5s] id=%-*d %%%.*f|%#x %y%lld%n|";
+  s21_format_t *fmt = s21_format_compile(format);
+  char str1[128], str2[128];
+  int n1 = 0, n2 = 0;
+  ck_assert_ptr_ne(fmt, NULL);
+  for (int i = 0; i < 50; i++) {
+    long long big = -123456789012LL * i;
+    int len1 = s21_sprintf(str1, format, "ts", "INFO", i % 2 ? -6 : 6, i, 2,
+                           i / 7.0, i * 977, big, &n1);
+    int len2 = s21_format_snprintf(str2, sizeof(str2), fmt, "ts", "INFO",
+                                   i % 2 ? -6 : 6, i, 2, i / 7.0, i * 977,
+                                   big, &n2);
+    ck_assert_int_eq(len1, len2);
+    ck_assert_str_eq(str1, str2);
+    ck_assert_int_eq(n1, n2);
+    ck_assert_int_eq(s21_format_snprintf(str2, 10, fmt, "ts", "INFO", 1, i, 1,
+                                         0.5, 1, big, &n2),
+                     s21_snprintf(str1, 10, format, "ts", "INFO", 1, i, 1,
+                                  0.5, 1, big, &n1));
+    ck_assert_str_eq(str1, str2);
+  }
+  s21_format_free(fmt);
+  fmt = s21_format_compile("no directives");
+  ck_assert_int_eq(s21_format_snprintf(s21_NULL, 0, fmt), 13);
+  s21_format_free(fmt);
+  ck_assert_ptr_eq(s21_format_compile("cut %-5"), NULL);
+  ck_assert_ptr_eq(s21_format_compile(s21_NULL), NULL);
+}
+END_TEST
+
+static char sink_text[1024];
+static s21_size_t sink_text_len;
+static int sink_flushes;
+
+// Collects what a sink flushes into sink_text.
+static int collect_flush(s21_sink *sink, s21_size_t need) {
+  (void)need;
+  memcpy(sink_text + sink_text_len, sink->buf, sink->len);
+  sink_text_len += sink->len;
+  sink->len = 0;
+  sink_flushes++;
+  return sink_flushes > *(int *)sink->ctx ? -1 : 0;
+}
+
+START_TEST(test_sink) {
+  char buf[16], expected[1024], str[256];
+  int limit = 1000, n = 0, len = 0;
+  s21_sink sink;
+  s21_sink_init(&sink, collect_flush, &limit, buf, sizeof(buf));
+  for (int i = 0; i < 20; i++) {
+    int res = sprintf(str, "record %d: %-8s|%5.2f%n;", i, "name", i / 3.0, &n);
+    ck_assert_int_eq(s21_sink_printf(&sink, "record %d: %-8s|%5.2f%n;", i,
+                                     "name", i / 3.0, &n),
+                     res);
+    ck_assert_int_eq(n, res - 1);
+    len += sprintf(expected + len, "%s", str);
+  }
+  ck_assert_int_eq(s21_sink_write(&sink, "end", 3), 0);
+  ck_assert_int_eq(s21_sink_flush(&sink), 0);
+  len += sprintf(expected + len, "end");
+  ck_assert_int_eq(sink_text_len, len);
+  ck_assert(memcmp(sink_text, expected, len) == 0);
+  // A failed flush fails the sink for good.
+  limit = sink_flushes;
+  ck_assert_int_eq(s21_sink_printf(&sink, "%40s", "x"), -1);
+  ck_assert_int_eq(s21_sink_printf(&sink, "x"), -1);
+  ck_assert_int_eq(s21_sink_flush(&sink), -1);
+
+  s21_sink_mem(&sink);
+  for (int i = 0; i < 1000; i++) s21_sink_printf(&sink, "%d,", i);
+  ck_assert_int_eq(s21_sink_flush(&sink), 0);
+  ck_assert_int_eq(sink.len, 3890);
+  ck_assert(memcmp(sink.buf + 3882, "998,999,", 8) == 0);
+  free(sink.buf);
+
+  int fds[2];
+  ck_assert_int_eq(pipe(fds), 0);
+  ck_assert_int_eq(s21_dprintf(fds[1], "%s=%05d\n", "fd", 42), 9);
+  s21_sink_fd(&sink, fds[1], buf, sizeof(buf));
+  s21_sink_printf(&sink, "%c%c", 'o', 'k');
+  ck_assert_int_eq(s21_sink_flush(&sink), 0);
+  ck_assert_int_eq(read(fds[0], str, sizeof(str)), 11);
+  ck_assert(memcmp(str, "fd=00042\nok", 11) == 0);
+  close(fds[0]);
+  close(fds[1]);
+
+  FILE *stream = tmpfile();
+  ck_assert_ptr_ne(stream, NULL);
+  ck_assert_int_eq(s21_fprintf(stream, "%s %+d %x", "file", 7, 255), 10);
+  rewind(stream);
+  ck_assert_ptr_ne(fgets(str, sizeof(str), stream), NULL);
+  ck_assert_str_eq(str, "file +7 ff");
+  fclose(stream);
+}
+END_TEST
+
+START_TEST(test_asprintf) {
+  char expected[8192], *str = s21_NULL;
+  for (int width = 0; width < 6000; width = width * 3 + 1) {
+    int len = snprintf(expected, sizeof expected, "[%*d|%s|%.3e]", width,
+                       width, "text", 0.5);
+    ck_assert_int_eq(
+        s21_asprintf(&str, "[%*d|%s|%.3e]", width, width, "text", 0.5), len);
+    ck_assert_str_eq(str, expected);
+    free(str);
+  }
+  ck_assert_int_eq(s21_asprintf(&str, ""), 0);
+  ck_assert_str_eq(str, "");
+  free(str);
+  ck_assert_int_eq(s21_asprintf(&str, "cut %-5"), -1);
+  ck_assert_ptr_eq(str, NULL);
+}
+END_TEST
+
+static int vsnprintf_both(char *str1, char *str2, s21_size_t size,
+                          const char *format, ...) {
+  va_list ap, ap2;
+  va_start(ap, format);
+  va_copy(ap2, ap);
+  int res = vsnprintf(str1, size, format, ap);
+  ck_assert_int_eq(res, s21_vsnprintf(str2, size, format, ap2));
+  va_end(ap2);
+  va_end(ap);
+  return res;
+}
+
+static int s21_vsprintf_wrap(char *str, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int res = s21_vsprintf(str, format, ap);
+  va_end(ap);
+  return res;
+}
+
+START_TEST(test_snprintf) {
+  char str1[64], str2[64];
+  const char *format = "id=%d name=%s f=%.2f %x%%";
+  for (s21_size_t size = 0; size < 40; size++) {
+    memset(str1, '#', sizeof(str1));
+    memset(str2, '#', sizeof(str2));
+    ck_assert_int_eq(snprintf(str1, size, format, -42, "abc", 3.14159, 255),
+                     s21_snprintf(str2, size, format, -42, "abc", 3.14159,
+                                  255));
+    ck_assert_mem_eq(str1, str2, sizeof(str1));
+  }
+  int need = s21_snprintf(s21_NULL, 0, format, 7, "sized", 2.5, 16);
+  char *exact = malloc(need + 1);
+  ck_assert_int_eq(s21_snprintf(exact, need + 1, format, 7, "sized", 2.5, 16),
+                   need);
+  ck_assert_str_eq(exact, "id=7 name=sized f=2.50 10%");
+  free(exact);
+  memset(str1, '#', sizeof(str1));
+  memset(str2, '#', sizeof(str2));
+  ck_assert_int_eq(vsnprintf_both(str1, str2, 8, "%s-%05d", "key", 12), 9);
+  ck_assert_mem_eq(str1, str2, sizeof(str1));
+  ck_assert_int_eq(sprintf(str1, "%c|%-4s|", 'z', "ab"),
+                   s21_vsprintf_wrap(str2, "%c|%-4s|", 'z', "ab"));
+  ck_assert_str_eq(str1, str2);
+  ck_assert_int_eq(s21_snprintf(str2, sizeof(str2), "bad %"), -1);
+}
+END_TEST
+
 Suite *string_suite(void) {
   Suite *s = suite_create("String_testcase");
   TCase *tc_string = tcase_create("Core");
 
   suite_add_tcase(s, tc_string);
   tcase_add_test(tc_string, test_strlen);
+  tcase_add_test(tc_string, test_strlen_long);
   tcase_add_test(tc_string, test_memset);
+  tcase_add_test(tc_string, test_memset_pattern);
   tcase_add_test(tc_string, test_memcmp);
+  tcase_add_test(tc_string, test_memcmp_long);
   tcase_add_test(tc_string, test_memcpy);
+  tcase_add_test(tc_string, test_memcpy_sizes);
   tcase_add_test(tc_string, test_memmove);
+  tcase_add_test(tc_string, test_memmove_overlap);
   tcase_add_test(tc_string, test_memchr);
+  tcase_add_test(tc_string, test_memchr_guard);
+  tcase_add_test(tc_string, test_memchr_family);
   tcase_add_test(tc_string, test_strcmp);
   tcase_add_test(tc_string, test_strncmp);
   tcase_add_test(tc_string, test_strstr);
+  tcase_add_test(tc_string, test_strstr_long);
+  tcase_add_test(tc_string, test_strstr_guard);
+  tcase_add_test(tc_string, test_searcher);
+  tcase_add_test(tc_string, test_multisearch);
   tcase_add_test(tc_string, test_strerror);
+  tcase_add_test(tc_string, test_strerror_r);
   tcase_add_test(tc_string, test_strcat);
   tcase_add_test(tc_string, test_strncat);
   tcase_add_test(tc_string, test_strcpy);
@@ -801,14 +1831,34 @@ Suite *string_suite(void) {
   tcase_add_test(tc_string, test_strspn);
   tcase_add_test(tc_string, test_strcspn);
   tcase_add_test(tc_string, test_strpbrk);
+  tcase_add_test(tc_string, test_span_long);
   tcase_add_test(tc_string, test_strtok);
+  tcase_add_test(tc_string, test_strtok_r);
+  tcase_add_test(tc_string, test_tokenizer);
+  tcase_add_test(tc_string, test_split);
   tcase_add_test(tc_string, test_toupper);
   tcase_add_test(tc_string, test_tolower);
   tcase_add_test(tc_string, test_insert);
   tcase_add_test(tc_string, test_trim);
+  tcase_add_test(tc_string, test_allocator);
+  tcase_add_test(tc_string, test_arena);
+  tcase_add_test(tc_string, test_str);
+  tcase_add_test(tc_string, test_u64toa);
   tcase_add_test(tc_string, test_simple_sprintf);
   tcase_add_test(tc_string, test_part1_sprintf);
   tcase_add_test(tc_string, test_part2_sprintf);
+  tcase_add_test(tc_string, test_sprintf_fields);
+  tcase_add_test(tc_string, test_sprintf_precision_guard);
+  tcase_add_test(tc_string, test_snprintf);
+  tcase_add_test(tc_string, test_format_compile);
+  tcase_add_test(tc_string, test_sink);
+  tcase_add_test(tc_string, test_asprintf);
+  tcase_add_test(tc_string, test_builder);
+  tcase_add_test(tc_string, test_float_exact);
+  tcase_add_test(tc_string, test_dtoa);
+  tcase_add_test(tc_string, test_strtoll);
+  tcase_add_test(tc_string, test_strtod);
+  tcase_add_test(tc_string, test_sscanf);
 
   return s;
 }